@@ -1,396 +1,659 @@
 #include "evol-puzzle.h"
 
+// The AVX2 kernels hold one 8-tile row of one-byte genes per vector, so other puzzle
+// sizes always use the scalar kernels (see HAS_AVX2_KERNELS).
+#ifdef EVOL_PUZZLE_X86_DISPATCH
+    #include <immintrin.h>
+#endif
 
-/**
- * @brief Generates a random number generator and a uniform integer distribution.
- * 
- * This function uses the high-resolution clock to seed a Mersenne Twister 
- * random number generator. It also creates a uniform integer distribution 
- * ranging from 0 to TILES_IN_PUZZLE_COUNT - 1.
- * 
- * @return A pair consisting of a seeded mt19937 generator and a uniform 
- * integer distribution.
- */
-pair<mt19937, uniform_int_distribution<int>> getRandomGen(){
-    // using a high-resolution clock to seed the random number generator
-    unsigned seed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
-    std::mt19937 generator(seed); // Mersenne Twister random number generator
-    std::uniform_int_distribution<int> distribution(0, TILES_IN_PUZZLE_COUNT - 1);
-
-    return make_pair(generator, distribution);
-}
+// instantiated at the end of this file
+#define EVOL_PUZZLE_EXTERN_TEMPLATE(W, H) \
+    extern template struct EvolPuzzle<W, H, SMALL_MOTIF_COUNT>; \
+    extern template struct EvolPuzzle<W, H, MAX_MOTIF_COUNT>;
+EVOL_PUZZLE_FOR_EACH_SIZE(EVOL_PUZZLE_EXTERN_TEMPLATE)
+#undef EVOL_PUZZLE_EXTERN_TEMPLATE
 
 
 /**
- * @brief Rotates the elements of the given array to the left by one index.
- * 
- * This function takes an array and shifts all its elements one position to the left.
- * The first element of the array is moved to the last position.
- * 
- * @param arr The array to be rotated. The array should have a size of TILE_SIZE.
+ * @brief Creates the random stream with the given id for a run seed.
+ *
+ * The stream id is scattered with an odd multiplier before being folded into the seed,
+ * and the result is expanded with SplitMix64, so nearby ids start far apart.
+ *
+ * @param seed The run seed (see --seed).
+ * @param stream The stream id.
+ * @return The seeded stream.
  */
-void rotateToLeftByOneIndex(int arr[]){
-    int temp = arr[0];
-    for (int i = 0; i < TILE_SIZE - 1; i++){
-        arr[i] = arr[i+1];
+Rng makeRng(uint64_t seed, uint64_t stream){
+    uint64_t x = seed ^ ((stream + 1) * 0xD1B54A32D192ED03ULL);
+    splitMix64(x);
+
+    Rng rng;
+    for (int i = 0; i < 4; i++){
+        rng.state[i] = splitMix64(x);
     }
-    arr[TILE_SIZE - 1] = temp;
+    return rng;
 }
 
 /**
- * @brief Rotates the elements of the given vector to the left by one index.
- *
- * This function takes a reference to a vector of integers and rotates its elements
- * to the left by one position. The first element of the vector is moved to the end.
+ * @brief Returns a seed taken from the high-resolution clock, for runs without --seed.
  *
- * @param tile A reference to a vector of integers to be rotated.
- * @return A vector of integers after rotating the elements to the left by one index.
+ * @return A clock-derived seed.
  */
-vector<int> rotateToLeftByOneIndexReturn(vector<int> &tile){
-    int temp = tile[0];
-    for (int i = 0; i < TILE_SIZE - 1; i++){
-        tile[i] = tile[i+1];
-    }
-    tile[TILE_SIZE - 1] = temp; 
-    
-    return tile;
+uint64_t getClockSeed(){
+    return std::chrono::high_resolution_clock::now().time_since_epoch().count();
 }
 
+
 /**
- * @brief Converts an array of integers to a vector of integers.
+ * @brief Rotates the edges of the given tile to the left by one index.
  * 
- * This function takes an array of integers and converts it into a 
- * std::vector<int> of the same size. The size of the array is 
- * determined by the constant TILE_SIZE.
+ * Each edge takes the motif of the next one and the top motif moves to the left
+ * edge. On a packed tile this is a single bit-rotate (see rotateTile).
  * 
- * @param arr The input array of integers to be converted.
- * @return std::vector<int> A vector containing the elements of the input array.
+ * @param tile The tile to be rotated in place.
  */
-vector<int> convertTileToVector(int arr[]){
-    vector<int> vec(TILE_SIZE);
-    
-    for (int i = 0; i < TILE_SIZE; i++){
-        vec[i] = arr[i];
-    }
-
-    return vec;
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::rotateToLeftByOneIndex(Tile &tile){
+    tile = rotateTile(tile);
 }
 
 /**
- * @brief Converts a vector of integers representing a tile into a string.
+ * @brief Rotates the tile placed by a gene to the left by one index.
  * 
- * This function takes a vector of integers and concatenates each integer
- * into a single string. The size of the vector is assumed to be TILE_SIZE.
+ * This is the genome equivalent of rotateToLeftByOneIndex: the tile index is kept
+ * and the rotation is incremented modulo TILE_SIZE.
  * 
- * @param vec A vector of integers representing the tile.
- * @return A string representation of the tile.
+ * @param gene The gene to be rotated in place.
  */
-string convertTileToString(vector<int> vec){
-    string result;
-    for (int i = 0; i < TILE_SIZE; i++){
-        result += to_string(vec[i]);
-    }
-    return result;
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::rotateGene(Gene &gene){
+    gene = makeGene(getGeneTile(gene), (getGeneRotation(gene) + 1) & ROTATION_MASK);
 }
 
 /**
- * @brief Converts an array of integers representing a tile to a string.
+ * @brief Converts a packed tile to a string.
  * 
- * This function takes an array of integers and concatenates each integer
- * into a single string. The size of the array is determined by the constant
- * TILE_SIZE.
+ * This function concatenates the TILE_SIZE motifs of the tile into a single
+ * string, e.g. "2310".
  * 
- * @param arr An array of integers representing the tile.
+ * @param tile The packed tile.
  * @return A string representation of the tile.
  */
-string convertTileToString(int arr[]){
+template<int WIDTH, int HEIGHT, int MOTIFS>
+string EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::convertTileToString(Tile tile){
     string result;
     for (int i = 0; i < TILE_SIZE; i++){
-        result += to_string(arr[i]);
+        result += motifToChar(getEdge(tile, i));
     }
     return result;
 }
 
 
 /**
- * @brief Records duplicate tiles in a puzzle.
+ * @brief Builds the canonical id table of the input tiles.
  *
- * This function takes a 2D array representing a puzzle and records the number of duplicate tiles.
- * Each tile is converted to a vector and then to a string representation. The function considers
- * all possible rotations of each tile to identify duplicates.
+ * This function assigns a canonical id to every distinct input tile (up to rotation),
+ * records it for all four rotations in the direct-indexed table, and counts how many
+ * input tiles share each id. It replaces the string-keyed maps previously built by
+ * buildMapOfTiles and recordDuplicateTiles.
  *
- * @param puzzle A 2D array representing the puzzle.
- * @return An unordered_map where the keys are string representations of tiles and the values are the counts of duplicates.
+ * @param input_tiles The TILES_IN_PUZZLE_COUNT packed tiles read by readInput.
+ * @return The canonical id table.
  */
-unordered_map<string, int> recordDuplicateTiles(int** puzzle){
-    unordered_map<string, int> duplicatesMap;
+template<int WIDTH, int HEIGHT, int MOTIFS>
+typename EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::TileClassTable EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::buildTileClassTable(const Tile* input_tiles){
+    TileClassTable tile_class_table;
+    memset(tile_class_table.canonical_id, -1, sizeof(tile_class_table.canonical_id));
+    memset(tile_class_table.multiplicity, 0, sizeof(tile_class_table.multiplicity));
+    tile_class_table.class_count = 0;
 
     for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
-        vector<int> tile = convertTileToVector(puzzle[i]);
-        vector<string> tile_rotations_vec(TILE_SIZE);
-        
-        tile_rotations_vec[0] = convertTileToString(tile);
-
-        for (int j = 1; j < TILE_SIZE; j++){
-            tile_rotations_vec[j] = convertTileToString(rotateToLeftByOneIndexReturn(tile));
-        }
-
-        string hit_key = "";
-        for (int j = 0; j < tile_rotations_vec.size(); j++){
-            if (duplicatesMap.find(tile_rotations_vec[j]) != duplicatesMap.end()){
-                hit_key = tile_rotations_vec[j];
+        int id = tile_class_table.canonical_id[encodeTileIndex(input_tiles[i])];
+
+        // first time this tile (in any rotation) is seen
+        if (id < 0){
+            id = tile_class_table.class_count++;
+            Tile tile = input_tiles[i];
+            for (int r = 0; r < TILE_SIZE; r++){
+                tile_class_table.canonical_id[encodeTileIndex(tile)] = id;
+                tile = rotateTile(tile);
             }
         }
 
-        if (hit_key == ""){
-            duplicatesMap[tile_rotations_vec[0]] = 1;
-        }
-        else{
-            duplicatesMap[hit_key] = duplicatesMap[hit_key] + 1;
-        }
+        tile_class_table.tile_class[i] = id;
+        tile_class_table.multiplicity[id]++;
     }
 
-    // removing elements from map that are not duplicates
-    // for (auto it = duplicatesMap.begin(); it != duplicatesMap.end();){
-    //     if (it->second == 1){
-    //         it = duplicatesMap.erase(it);
-    //     }
-    //     else{
-    //         it++;
-    //     }
-    // }
-
-    return duplicatesMap; 
+    return tile_class_table;
 }
 
 /**
- * @brief Builds a map of tiles from a given puzzle.
+ * @brief Checks that a four-digit puzzle uses exactly the input tiles.
  *
- * This function takes a 2D array representing a puzzle and constructs an unordered map
- * where each unique tile (and its rotations) is mapped to its string representation.
+ * Each tile is looked up in the canonical id table, in whatever rotation it is
+ * placed, and counted in a stack-allocated array. The puzzle is valid if every
+ * canonical id appears exactly as many times as in the input.
  *
- * @param puzzle A 2D array of integers representing the puzzle tiles.
- * @return An unordered_map where the key is the string representation of a tile (or its rotations)
- *         and the value is the original string representation of the tile.
+ * @param tiles TILES_IN_PUZZLE_COUNT packed tiles, e.g. from decodePuzzle.
+ * @param tile_class_table The canonical id table built from the input puzzle.
+ * @return true if the tiles are a rearrangement of the input tiles, false otherwise.
  */
-unordered_map <string, string> buildMapOfTiles(int** puzzle){
-    unordered_map <string, string> map_of_tiles;
-    
-    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
-        vector<int> tile = convertTileToVector(puzzle[i]);
-        
-        string id_tile = convertTileToString(tile);
-        if (map_of_tiles.find(id_tile) == map_of_tiles.end()){
-            map_of_tiles[id_tile] = id_tile;
+template<int WIDTH, int HEIGHT, int MOTIFS>
+bool EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::hasInputTileCounts(const Tile* tiles, const TileClassTable &tile_class_table){
+    TileClassId counts[TILES_IN_PUZZLE_COUNT] = {0};
 
-            for (int j = 1; j < TILE_SIZE; j++){
-                map_of_tiles[convertTileToString(rotateToLeftByOneIndexReturn(tile))] = id_tile;
-            }
-        }   
+    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+        int id = tile_class_table.canonical_id[encodeTileIndex(tiles[i])];
+        if (id < 0 || ++counts[id] > tile_class_table.multiplicity[id]){
+            return false;
+        }
     }
 
-    return map_of_tiles;
+    return true;
 }
 
-
 /**
- * @brief Builds a map of tile strings and their counts from a given puzzle.
+ * @brief Swaps two random tiles in a 2D array.
  *
- * This function processes a 2D puzzle array and generates a map where each key is a string 
- * representation of a tile (or its rotations) and the value is the count of how many times 
- * that tile (or its rotations) appears in the specified range of the puzzle.
+ * This function selects two distinct random indices within the range of the puzzle tiles
+ * and swaps the tiles at these indices.
  *
- * @param puzzle A 2D array representing the puzzle.
- * @param start_index The starting index of the range in the puzzle to process.
- * @param end_index The ending index of the range in the puzzle to process.
- * @return An unordered_map where keys are string representations of tiles and values are their counts.
+ * @param arr The puzzle whose tiles are swapped.
+ * @param rng The random stream used to pick the indices.
  */
-unordered_map <string, int> buildMapOfTiles(int** puzzle, const int start_index, const int end_index){
-    unordered_map <string, int> map_of_tiles;
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::swapTile(Puzzle arr, Rng &rng){
+    int first_index = randomTileIndex(rng);
+    int second_index = first_index;
+    while (second_index == first_index){
+        second_index = randomTileIndex(rng);
+    }
 
-    for (int i = start_index; i < end_index; i++){
-        vector<int> tile = convertTileToVector(puzzle[i]);
-        vector<string> tile_rotations_vec(TILE_SIZE);
-        
-        tile_rotations_vec[0] = convertTileToString(tile);
+    Gene temp_tile = arr[first_index];
+    arr[first_index] = arr[second_index];
+    arr[second_index] = temp_tile;
+}
 
-        for (int j = 1; j < TILE_SIZE; j++){
-            tile_rotations_vec[j] = convertTileToString(rotateToLeftByOneIndexReturn(tile));
-        }
+/**
+ * @brief Counts the edge mismatches between a position and its (up to 4) neighbours.
+ *
+ * @param puzzle The puzzle.
+ * @param index The position whose edges are checked.
+ * @param edge_table The edge table built from the input puzzle.
+ * @return The number of mismatching edges around that position.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::countLocalEdgeMismatch(const Gene* puzzle, int index, const EdgeTable &edge_table){
+    int row = index / PUZZLE_WIDTH;
+    int col = index % PUZZLE_WIDTH;
+    Gene gene = puzzle[index];
+    int edge_mismatch = 0;
 
-        string hit_key = "";
-        for (int j = 0; j < tile_rotations_vec.size(); j++){
-            if (map_of_tiles.find(tile_rotations_vec[j]) != map_of_tiles.end()){
-                hit_key = tile_rotations_vec[j];
-            }
-        }
+    if (col > 0){
+        edge_mismatch += getGeneEdge(edge_table, gene, LEFT) != getGeneEdge(edge_table, puzzle[index - 1], RIGHT);
+    }
+    if (col < PUZZLE_WIDTH - 1){
+        edge_mismatch += getGeneEdge(edge_table, gene, RIGHT) != getGeneEdge(edge_table, puzzle[index + 1], LEFT);
+    }
+    if (row > 0){
+        edge_mismatch += getGeneEdge(edge_table, gene, TOP) != getGeneEdge(edge_table, puzzle[index - PUZZLE_WIDTH], BOTTOM);
+    }
+    if (row < PUZZLE_HEIGHT - 1){
+        edge_mismatch += getGeneEdge(edge_table, gene, BOTTOM) != getGeneEdge(edge_table, puzzle[index + PUZZLE_WIDTH], TOP);
+    }
 
-        if (hit_key == ""){
-            map_of_tiles[tile_rotations_vec[0]] = 1;
-        }
-        else{
-            map_of_tiles[hit_key] = map_of_tiles[hit_key] + 1;
-        }
+    return edge_mismatch;
+}
+
+/**
+ * @brief Counts the edge mismatches touching either of two positions, each edge once.
+ *
+ * @param puzzle The puzzle.
+ * @param first_index The first position.
+ * @param second_index The second position.
+ * @param edge_table The edge table built from the input puzzle.
+ * @return The number of mismatching edges around both positions.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::countPairEdgeMismatch(const Gene* puzzle, int first_index, int second_index, const EdgeTable &edge_table){
+    int edge_mismatch = countLocalEdgeMismatch(puzzle, first_index, edge_table) + countLocalEdgeMismatch(puzzle, second_index, edge_table);
+
+    // an edge shared by the two positions was counted from both sides
+    int low = min(first_index, second_index);
+    int high = max(first_index, second_index);
+    if (high - low == 1 && low % PUZZLE_WIDTH != PUZZLE_WIDTH - 1){
+        edge_mismatch -= getGeneEdge(edge_table, puzzle[low], RIGHT) != getGeneEdge(edge_table, puzzle[high], LEFT);
+    }
+    else if (high - low == PUZZLE_WIDTH){
+        edge_mismatch -= getGeneEdge(edge_table, puzzle[low], BOTTOM) != getGeneEdge(edge_table, puzzle[high], TOP);
     }
 
-    return map_of_tiles;
+    return edge_mismatch;
 }
 
 /**
- * @brief Checks if any rotation of a given tile is present in the provided map.
+ * @brief Swaps the tiles at two positions and returns the resulting change in edge mismatch.
  *
- * This function takes a map and a tile, generates all possible rotations of the tile,
- * and checks if any of these rotations exist in the map. If a match is found, it returns
- * a pair containing true and the matching rotation string. If no match is found, it returns
- * a pair containing false and an empty string.
+ * Only the (at most 8) edges around the two positions can change, so the delta is
+ * computed from those alone instead of rescanning the whole puzzle.
  *
- * @param map_to_search The unordered map to search for the tile rotations.
- * @param tile The tile represented as a vector of integers.
- * @return A pair where the first element is a boolean indicating if a match was found,
- *         and the second element is the matching rotation string if a match was found,
- *         or an empty string if no match was found.
+ * @param puzzle The puzzle to modify.
+ * @param first_index The first position.
+ * @param second_index The second position.
+ * @param edge_table The edge table built from the input puzzle.
+ * @return The edge mismatch count after the swap minus the count before it.
  */
-pair<bool, string> isTileInMap(const unordered_map<string, int> &map_to_search, vector<int> tile){
-    vector<string> tile_rotations_vec(TILE_SIZE);
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::swapTileDelta(Puzzle puzzle, int first_index, int second_index, const EdgeTable &edge_table){
+    int before = countPairEdgeMismatch(puzzle, first_index, second_index, edge_table);
 
-    tile_rotations_vec[0] = convertTileToString(tile);
+    Gene temp_tile = puzzle[first_index];
+    puzzle[first_index] = puzzle[second_index];
+    puzzle[second_index] = temp_tile;
 
-    for (int j = 1; j < TILE_SIZE; j++){
-        tile_rotations_vec[j] = convertTileToString(rotateToLeftByOneIndexReturn(tile));
-    }
+    return countPairEdgeMismatch(puzzle, first_index, second_index, edge_table) - before;
+}
 
-    int tile_rotations_vec_size = tile_rotations_vec.size();
-    for (int i = 0; i < tile_rotations_vec_size; i++){
-        if (map_to_search.find(tile_rotations_vec[i]) != map_to_search.end()){
-            return make_pair(true, tile_rotations_vec[i]);
-        }
-    }
-    return make_pair(false, "");
+/**
+ * @brief Rotates the tile at a position and returns the resulting change in edge mismatch.
+ *
+ * @param puzzle The puzzle to modify.
+ * @param index The position of the tile to rotate (see rotateGene).
+ * @param edge_table The edge table built from the input puzzle.
+ * @return The edge mismatch count after the rotation minus the count before it.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::rotateGeneDelta(Puzzle puzzle, int index, const EdgeTable &edge_table){
+    int before = countLocalEdgeMismatch(puzzle, index, edge_table);
+    rotateGene(puzzle[index]);
+    return countLocalEdgeMismatch(puzzle, index, edge_table) - before;
 }
 
+
 /**
- * @brief Checks if a tile is present in the given map.
- * 
- * This function searches for a specified tile in an unordered map and returns
- * a pair indicating whether the tile was found and the tile itself if found.
- * 
- * @param map_to_search The unordered map to search within.
- * @param tile The tile to search for in the map.
- * @return A pair where the first element is a boolean indicating if the tile
- *         was found (true if found, false otherwise), and the second element
- *         is the tile itself if found, or an empty string if not found.
+ * @brief Turns the tile at a position to the rotation that best matches its neighbours.
+ *
+ * The motifs the neighbours show the position are read once, then all four rotations
+ * are scored from the edge table, which already holds the edges of every tile in every
+ * rotation. On a tie the current rotation is kept, so the edge mismatch count never
+ * goes up.
+ *
+ * @param puzzle The puzzle to modify.
+ * @param index The position of the tile to turn.
+ * @param edge_table The edge table built from the input puzzle.
+ * @return The edge mismatch count after the change minus the count before it.
  */
-pair<bool, string> isTileInMap(const unordered_map<string, int> &map_to_search, string tile){
-    if (map_to_search.find(tile) != map_to_search.end()){
-        return make_pair(true, tile);
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::bestRotationDelta(Puzzle puzzle, int index, const EdgeTable &edge_table){
+    int row = index / PUZZLE_WIDTH;
+    int col = index % PUZZLE_WIDTH;
+
+    // the motif each neighbour shows this position, -1 on the border
+    int facing[TILE_SIZE];
+    facing[TOP] = row > 0 ? getGeneEdge(edge_table, puzzle[index - PUZZLE_WIDTH], BOTTOM) : -1;
+    facing[RIGHT] = col < PUZZLE_WIDTH - 1 ? getGeneEdge(edge_table, puzzle[index + 1], LEFT) : -1;
+    facing[BOTTOM] = row < PUZZLE_HEIGHT - 1 ? getGeneEdge(edge_table, puzzle[index + PUZZLE_WIDTH], TOP) : -1;
+    facing[LEFT] = col > 0 ? getGeneEdge(edge_table, puzzle[index - 1], RIGHT) : -1;
+
+    int tile = getGeneTile(puzzle[index]);
+    int current_rotation = getGeneRotation(puzzle[index]);
+    int edge_mismatch[TILE_SIZE];
+    for (int r = 0; r < TILE_SIZE; r++){
+        const uint8_t* edges = edge_table.edges[tile][r];
+        edge_mismatch[r] = 0;
+        for (int e = 0; e < TILE_SIZE; e++){
+            edge_mismatch[r] += facing[e] >= 0 && edges[e] != facing[e];
+        }
+    }
+
+    int best_rotation = current_rotation;
+    for (int r = 0; r < TILE_SIZE; r++){
+        if (edge_mismatch[r] < edge_mismatch[best_rotation]){
+            best_rotation = r;
+        }
     }
-    return make_pair(false, "");
+    puzzle[index] = makeGene(tile, best_rotation);
+    return edge_mismatch[best_rotation] - edge_mismatch[current_rotation];
 }
 
 /**
- * @brief Checks if a tile is present in the given map and returns its corresponding value.
+ * @brief Gives every tile of a puzzle its best rotation for the current placement.
  *
- * This function searches for a specified tile in the provided unordered map. If the tile is found,
- * it returns a pair containing `true` and the value associated with the tile. If the tile is not found,
- * it returns a pair containing `false` and an empty string.
+ * Every position is checked once with bestRotationDelta, and turning a tile queues its
+ * neighbours to be checked again, since their best rotation may have changed. Every
+ * turn lowers the edge mismatch count, so this stops at a fixpoint where no single
+ * tile can be turned to a better rotation. Tile positions are left alone.
  *
- * @param map_to_search The unordered map to search for the tile.
- * @param tile The tile to search for in the map.
- * @return A pair where the first element is a boolean indicating whether the tile was found,
- *         and the second element is the value associated with the tile if found, or an empty string if not found.
+ * @param puzzle The puzzle to repair in place.
+ * @param edge_table The edge table built from the input puzzle.
+ * @return The edge mismatch count after the repair minus the count before it.
  */
-pair<bool, string> isTileInMap(const unordered_map<string, string> &map_to_search, string tile){
-    if (map_to_search.find(tile) != map_to_search.end()){
-        return make_pair(true, map_to_search.at(tile));
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::repairRotations(Puzzle puzzle, const EdgeTable &edge_table){
+    // every position is checked once; after that only the neighbours of a turned tile can improve
+    int pending_index[TILES_IN_PUZZLE_COUNT];
+    bool is_pending[TILES_IN_PUZZLE_COUNT];
+    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+        pending_index[i] = TILES_IN_PUZZLE_COUNT - 1 - i;
+        is_pending[i] = true;
+    }
+
+    int total_delta = 0;
+    int pending_count = TILES_IN_PUZZLE_COUNT;
+    while (pending_count > 0){
+        int i = pending_index[--pending_count];
+        is_pending[i] = false;
+
+        // a tile without a mismatching edge is already in its best rotation
+        if (countLocalEdgeMismatch(puzzle, i, edge_table) == 0){
+            continue;
+        }
+        int delta = bestRotationDelta(puzzle, i, edge_table);
+        if (delta == 0){
+            continue;
+        }
+        total_delta += delta;
+
+        int col = i % PUZZLE_WIDTH;
+        int neighbour_index[TILE_SIZE] = {
+            i >= PUZZLE_WIDTH ? i - PUZZLE_WIDTH : -1,
+            col < PUZZLE_WIDTH - 1 ? i + 1 : -1,
+            i + PUZZLE_WIDTH < TILES_IN_PUZZLE_COUNT ? i + PUZZLE_WIDTH : -1,
+            col > 0 ? i - 1 : -1
+        };
+        for (int neighbour : neighbour_index){
+            if (neighbour >= 0 && !is_pending[neighbour]){
+                is_pending[neighbour] = true;
+                pending_index[pending_count++] = neighbour;
+            }
+        }
     }
-    return make_pair(false, "");
+    return total_delta;
 }
 
 
 /**
- * @brief Swaps two random tiles in a 2D array.
- *
- * This function selects two distinct random indices within the range of the puzzle tiles
- * and swaps the tiles at these indices. The random selection is seeded using a high-resolution
- * clock to ensure variability.
+ * @brief Reads the tiles of a puzzle input file as strings, one row per non-empty line.
  *
- * @param arr A pointer to a 2D array representing the puzzle tiles.
+ * @param filename The path to the input file.
+ * @return The rows of the file.
  *
- * @note The array is assumed to have a size of TILES_IN_PUZZLE_COUNT x TILE_SIZE.
+ * @throws runtime_error If the file cannot be opened.
  */
-void swapTile(int** arr, pair<mt19937, uniform_int_distribution<int>> random){
-    // using a high-resolution clock to seed the random number generator
-
-    int first_index = random.second(random.first);
-    int second_index = first_index;
-    while (second_index == first_index){
-        second_index = random.second(random.first);
+static vector<vector<string>> readInputRows(const string &filename){
+    ifstream file(filename);
+    
+    if (!file) {
+        throw runtime_error("Unable to open file " + filename);
     }
 
-    int temp_tile[TILE_SIZE];
-    for (int i = 0; i < TILE_SIZE; i++){
-        temp_tile[i] = arr[first_index][i];
-    }
-    
-    for (int i = 0; i < TILE_SIZE; i++){
-        arr[first_index][i] = arr[second_index][i];
+    // Parsing each non-empty line into a row of tiles
+    vector<vector<string>> rows;
+    string line;
+    while (getline(file, line)) {
+        istringstream stream(line);
+        vector<string> row;
+        string number;
+        while (stream >> number) {  // Reading each tile as a string
+            row.emplace_back(number);
+        }
+        if (!row.empty()) {
+            rows.emplace_back(row);
+        }
     }
+    return rows;
+}
 
-    for (int i = 0; i < TILE_SIZE; i++){
-        arr[second_index][i] = temp_tile[i];
+/**
+ * @brief Reads the shape of a puzzle input file without parsing its tiles.
+ *
+ * The motif count is the highest motif of any tile plus one, so a file using the
+ * motifs 0-6 has 7 whether or not each of them appears.
+ *
+ * @param filename The path to the input file.
+ * @param width Receives the number of tiles on each line.
+ * @param height Receives the number of non-empty lines.
+ * @param motif_count Receives the highest motif in the file plus one.
+ *
+ * @throws runtime_error If the file cannot be opened, its lines differ in length or a
+ *         tile holds a character that is not a motif.
+ */
+void readInputShape(const string &filename, int &width, int &height, int &motif_count){
+    vector<vector<string>> rows = readInputRows(filename);
+
+    height = (int)rows.size();
+    width = rows.empty() ? 0 : (int)rows[0].size();
+    motif_count = 0;
+    for (const vector<string> &row : rows) {
+        if ((int)row.size() != width) {
+            throw runtime_error(filename + " is not a rectangular puzzle, its lines hold different numbers of tiles");
+        }
+        for (const string &number : row) {
+            for (char c : number) {
+                int motif = charToMotif(c);
+                if (motif < 0) {
+                    throw runtime_error(filename + ": tile " + number + " holds a character that is not a motif (0-9, a-z)");
+                }
+                motif_count = max(motif_count, motif + 1);
+            }
+        }
     }
 }
 
+/**
+ * @brief Parses the command-line options of main (documented in main.cpp) into `options`.
+ *
+ * Unknown arguments are skipped; an unknown method name keeps the default and is reported.
+ *
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @param options Receives the parsed options, the other fields keep their values.
+ */
+void parseRunOptions(int argc, char** argv, RunOptions &options){
+    for (int i = 1; i < argc; i++){
+        if (string(argv[i]) == "-v"){
+            options.print_flag = true;
+        } else if (string(argv[i]) == "--seed" && i + 1 < argc){
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (string(argv[i]) == "--threads" && i + 1 < argc){
+            int thread_count = atoi(argv[++i]);
+#ifdef _OPENMP
+            omp_set_num_threads(max(1, thread_count));
+#else
+            if (thread_count > 1){
+                cout << "Built without OpenMP, --threads is ignored" << endl;
+            }
+#endif
+        } else if (string(argv[i]) == "--islands" && i + 1 < argc){
+            options.island_count = max(1, atoi(argv[++i]));
+        } else if (string(argv[i]) == "--processes" && i + 1 < argc){
+            options.process_count = max(1, atoi(argv[++i]));
+        } else if (string(argv[i]) == "--topology" && i + 1 < argc){
+            string name = argv[++i];
+            if (name == "full"){
+                options.topology = FULLY_CONNECTED_TOPOLOGY;
+            } else if (name == "random"){
+                options.topology = RANDOM_TOPOLOGY;
+            } else if (name == "ring"){
+                options.topology = RING_TOPOLOGY;
+            } else {
+                cerr << "Unknown topology " << name << ", using ring" << endl;
+            }
+        } else if (string(argv[i]) == "--migration-interval" && i + 1 < argc){
+            options.migration_interval = max(1, atoi(argv[++i]));
+        } else if (string(argv[i]) == "--migrants" && i + 1 < argc){
+            options.migrant_count = max(1, atoi(argv[++i]));
+        } else if (string(argv[i]) == "--selection" && i + 1 < argc){
+            string name = argv[++i];
+            if (name == "tournament"){
+                options.selection_method = TOURNAMENT_SELECTION;
+            } else if (name == "sus"){
+                options.selection_method = SUS_SELECTION;
+            } else if (name == "rank-roulette"){
+                options.selection_method = RANK_ROULETTE_SELECTION;
+            } else if (name == "truncation"){
+                options.selection_method = TRUNCATION_SELECTION;
+            } else {
+                cerr << "Unknown selection " << name << ", using truncation" << endl;
+            }
+        } else if (string(argv[i]) == "--local-search" && i + 1 < argc){
+            string name = argv[++i];
+            if (name == "first"){
+                options.local_search_method = FIRST_IMPROVEMENT_LOCAL_SEARCH;
+            } else if (name == "best"){
+                options.local_search_method = BEST_IMPROVEMENT_LOCAL_SEARCH;
+            } else if (name == "none"){
+                options.local_search_method = NO_LOCAL_SEARCH;
+            } else {
+                cerr << "Unknown local search " << name << ", using none" << endl;
+            }
+        } else if (string(argv[i]) == "--init" && i + 1 < argc){
+            string name = argv[++i];
+            if (name == "random"){
+                options.initialization_method = RANDOM_INITIALIZATION;
+            } else if (name == "greedy"){
+                options.initialization_method = GREEDY_INITIALIZATION;
+            } else {
+                cerr << "Unknown initialization " << name << ", using random" << endl;
+            }
+        } else if (string(argv[i]) == "--steady-state"){
+            options.steady_state_flag = true;
+        } else if (string(argv[i]) == "--anneal"){
+            options.anneal_flag = true;
+        } else if (string(argv[i]) == "--cooling" && i + 1 < argc){
+            string name = argv[++i];
+            if (name == "linear"){
+                options.annealing_settings.schedule = LINEAR_COOLING;
+            } else if (name == "lundy-mees"){
+                options.annealing_settings.schedule = LUNDY_MEES_COOLING;
+            } else if (name == "geometric"){
+                options.annealing_settings.schedule = GEOMETRIC_COOLING;
+            } else {
+                cerr << "Unknown cooling schedule " << name << ", using geometric" << endl;
+            }
+        } else if (string(argv[i]) == "--temperatures" && i + 2 < argc){
+            double initial_temperature = atof(argv[++i]);
+            double final_temperature = atof(argv[++i]);
+            if (initial_temperature > 0 && final_temperature > 0){
+                options.annealing_settings.initial_temperature = initial_temperature;
+                options.annealing_settings.final_temperature = final_temperature;
+            } else {
+                cerr << "Temperatures must be positive, using the defaults" << endl;
+            }
+        } else if (string(argv[i]) == "--reheat-interval" && i + 1 < argc){
+            options.annealing_settings.reheat_interval = max(0, atoi(argv[++i]));
+        } else if (string(argv[i]) == "--replicas" && i + 1 < argc){
+            options.annealing_settings.replica_count = max(1, atoi(argv[++i]));
+        } else if (string(argv[i]) == "--exact"){
+            options.exact_flag = true;
+        } else if (string(argv[i]) == "--exact-nodes" && i + 1 < argc){
+            options.exact_node_limit = max(1LL, atoll(argv[++i]));
+        } else if (string(argv[i]) == "--completion-nodes" && i + 1 < argc){
+            options.completion_node_limit = max(0LL, atoll(argv[++i]));
+        }
+    }
+}
 
 /**
- * @brief Reads a puzzle input from a file and stores it in a 2D array.
+ * @brief Reads a puzzle input from a file and stores it as packed tiles.
  * 
- * This function reads the contents of the specified file, parses it into a 2D array of integers,
- * and stores the result in the provided 2D array `puzzle`.
+ * This function reads the contents of the specified file, parses each four-character
+ * tile (one motif per character, see charToMotif) into a packed tile, and stores the
+ * result in the provided array `puzzle`.
  * 
  * @param filename The path to the input file containing the puzzle data.
- * @param puzzle A pointer to a 2D array where the parsed puzzle data will be stored.
+ * @param puzzle An array of TILES_IN_PUZZLE_COUNT tiles where the parsed puzzle data will be stored.
  * 
- * @note The input file should contain numbers arranged in a specific format that can be parsed
- *       into a 2D array of integers.
- * @note The dimensions of the `puzzle` array should match the expected dimensions defined by
- *       `TILES_IN_PUZZLE_COUNT` and `TILE_SIZE`.
+ * @note The input file holds PUZZLE_HEIGHT non-empty lines of PUZZLE_WIDTH tiles each.
+ *       readInputShape reads the shape first so that dispatchGeometry can pick the
+ *       matching instantiation; a file of another shape is rejected here.
  * 
- * @throws runtime_error If the file cannot be opened.
+ * @throws runtime_error If the file cannot be opened or does not match the puzzle geometry.
  */
-void readInput(string filename, int** puzzle){
-    ifstream file(filename);
-    
-    if (!file) {
-        cerr << "Unable to open file numbers.txt";
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::readInput(string filename, Tile* puzzle){
+    vector<vector<string>> rows = readInputRows(filename);
+
+    size_t width = rows.empty() ? 0 : rows[0].size();
+    for (const vector<string> &row : rows) {
+        width = row.size() == width ? width : 0;
+    }
+    if (rows.size() != (size_t)PUZZLE_HEIGHT || width != (size_t)PUZZLE_WIDTH) {
+        ostringstream message;
+        message << filename << " is not a " << PUZZLE_WIDTH << "x" << PUZZLE_HEIGHT << " puzzle";
+        throw runtime_error(message.str());
     }
-    
-    // Reading file into a string
-    stringstream buffer;
-    buffer << file.rdbuf();
-    string content = buffer.str();
 
-    file.close();
+    // packing each tile's characters into a tile
+    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+        const string &number = rows[i / PUZZLE_WIDTH][i % PUZZLE_WIDTH];
+        int edges[TILE_SIZE];
+        for (int e = 0; e < TILE_SIZE; e++){
+            edges[e] = e < (int)number.size() ? charToMotif(number[e]) : -1;
+            if (edges[e] < 0 || edges[e] >= MOTIF_COUNT || number.size() != TILE_SIZE){
+                ostringstream message;
+                message << filename << ": tile " << number << " is not " << TILE_SIZE << " motifs in 0.." << motifToChar(MOTIF_COUNT - 1);
+                throw runtime_error(message.str());
+            }
+        }
+        puzzle[i] = packTile(edges);
+    }
+}
 
-    // Parsing the content into a 2D vector of digits
-    vector<vector<int>> digitsArray;
-    istringstream stream(content);
-    string number;
+/**
+ * @brief Builds the edge table of the input tiles.
+ * 
+ * This function computes, once, the four rotations of every input tile and the
+ * motif on each of their edges, so the genetic operators never have to rotate
+ * tiles again.
+ * 
+ * @param input_tiles The TILES_IN_PUZZLE_COUNT packed tiles read by readInput.
+ * @return The edge table.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+typename EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::EdgeTable EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::buildEdgeTable(const Tile* input_tiles){
+    EdgeTable edge_table;
 
-    while (stream >> number) {  // Reading each number as a string
-        vector<int> tile;  
-        for (char digit : number) {  // Iterating through each character
-            tile.emplace_back(digit - '0');  // Converting char to int and adding to row
+    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+        Tile tile = input_tiles[i];
+        for (int r = 0; r < TILE_SIZE; r++){
+            edge_table.tiles[i][r] = tile;
+            for (int e = 0; e < TILE_SIZE; e++){
+                edge_table.edges[i][r][e] = getEdge(tile, e);
+            }
+            tile = rotateTile(tile);
         }
-        // Adding the row of digits to the 2D array
-        digitsArray.emplace_back(tile);
     }
 
-    // copying from vector<vector<int>> to normal 2d int array
+    return edge_table;
+}
+
+/**
+ * @brief Writes the input arrangement into a puzzle.
+ * 
+ * Position i receives input tile i with no rotation.
+ * 
+ * @param puzzle The puzzle to initialize.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::writeInputOrder(Puzzle puzzle){
     for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
-        for (int j = 0; j < TILE_SIZE; j++){
-            puzzle[i][j] = digitsArray[i][j];
-        }
+        puzzle[i] = makeGene(i, 0);
+    }
+}
+
+/**
+ * @brief Converts a puzzle back to packed tiles in the four-digit format.
+ * 
+ * @param puzzle The puzzle to convert.
+ * @param edge_table The edge table built from the input puzzle.
+ * @param tiles An array of TILES_IN_PUZZLE_COUNT tiles receiving the rotated tiles.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::decodePuzzle(const Gene* puzzle, const EdgeTable &edge_table, Tile* tiles){
+    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+        tiles[i] = geneToTile(edge_table, puzzle[i]);
     }
 }
 
@@ -398,21 +661,31 @@ void readInput(string filename, int** puzzle){
 /**
  * @brief Allocates memory for a population of individuals.
  * 
- * This function allocates a 3D array to represent a population of individuals
- * for a genetic algorithm or evolutionary computation. Each individual in the 
- * population is represented by a 2D array.
+ * This function allocates a single contiguous buffer holding every individual of
+ * the population. Each individual starts on a cache line boundary and consecutive
+ * individuals are `stride` genes apart.
  * 
  * @param population_size The number of individuals in the population.
- * @return A pointer to the allocated 3D array representing the population.
+ * @return The allocated population.
  */
-int*** allocatePopulation(int population_size) {
-    int*** population = new int**[population_size];
-    for (int i = 0; i < population_size; ++i) {
-        population[i] = new int*[TILES_IN_PUZZLE_COUNT];
-        for (int j = 0; j < TILES_IN_PUZZLE_COUNT; ++j) {
-            population[i][j] = new int[TILE_SIZE];
-        }
-    }
+template<int WIDTH, int HEIGHT, int MOTIFS>
+typename EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::Population EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::allocatePopulation(int population_size) {
+    const int puzzle_bytes = TILES_IN_PUZZLE_COUNT * sizeof(Gene);
+    const int stride_bytes = (puzzle_bytes + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+
+    Population population;
+    population.size = population_size;
+    population.stride = stride_bytes / sizeof(Gene);
+
+    // over-allocating by one cache line so the start can be aligned by hand
+    population.raw = new char[(size_t)population_size * stride_bytes + CACHE_LINE_SIZE];
+    uintptr_t address = reinterpret_cast<uintptr_t>(population.raw);
+    address = (address + CACHE_LINE_SIZE - 1) & ~(uintptr_t)(CACHE_LINE_SIZE - 1);
+    population.data = reinterpret_cast<Gene*>(address);
+    population.fitness = new int[population_size];
+    population.dirty = new bool[population_size];
+    fill(population.dirty, population.dirty + population_size, true);
+
     return population;
 }
 
@@ -420,199 +693,796 @@ int*** allocatePopulation(int population_size) {
 /**
  * @brief Allocates memory for a puzzle.
  * 
- * This function dynamically allocates a 2D array to represent a puzzle.
- * The puzzle is represented as an array of pointers, where each pointer
- * points to an array of integers. The size of the puzzle and the size
- * of each tile are determined by the constants TILES_IN_PUZZLE_COUNT
- * and TILE_SIZE, respectively.
+ * This function allocates TILES_IN_PUZZLE_COUNT contiguous genes in a single allocation.
  * 
- * @return int** A pointer to the allocated 2D array representing the puzzle.
+ * @return Puzzle A pointer to the first gene of the allocated puzzle.
  */
-int** allocatePuzzle() {
-    int** puzzle = new int*[TILES_IN_PUZZLE_COUNT];
-    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; ++i) {
-        puzzle[i] = new int[TILE_SIZE];
-    }
-    return puzzle;
+template<int WIDTH, int HEIGHT, int MOTIFS>
+typename EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::Puzzle EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::allocatePuzzle() {
+    return new Gene[TILES_IN_PUZZLE_COUNT];
 }
 
 /**
- * @brief Frees the memory allocated for a 2D puzzle array.
+ * @brief Frees the memory allocated for a puzzle.
  * 
- * This function deallocates the memory for each row of the puzzle
- * and then deallocates the memory for the array of row pointers.
- * 
- * @param puzzle A pointer to the 2D array representing the puzzle.
+ * @param puzzle The puzzle returned by allocatePuzzle.
  */
-void freePuzzle(int** puzzle) {
-    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; ++i) {
-        delete[] puzzle[i];
-    }
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::freePuzzle(Puzzle puzzle) {
     delete[] puzzle;
 }
 
 /**
  * @brief Frees the memory allocated for a population of puzzle solutions.
  *
- * This function deallocates the memory used by a 3D array representing a population
- * of puzzle solutions. It iterates through each solution in the population, freeing
- * the memory allocated for each tile and then freeing the memory allocated for each
- * solution. Finally, it frees the memory allocated for the population array itself.
+ * This function releases the single buffer backing the population and resets
+ * the population to an empty state.
  *
- * @param population_arr A pointer to a 3D array representing the population of puzzle solutions.
- *                       The array is of size [population_size][TILES_IN_PUZZLE_COUNT][TILE_SIZE].
- * @param population_size The number of solutions in the population.
+ * @param population The population returned by allocatePopulation.
  */
-void freePopulation(int*** population_arr, int population_size) {
-    for (int i = 0; i < population_size; i++) {
-        for (int j = 0; j < TILES_IN_PUZZLE_COUNT; j++) {
-            delete[] population_arr[i][j];
-        }
-        delete[] population_arr[i];
-    }
-    delete[] population_arr;
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::freePopulation(Population &population) {
+    delete[] population.raw;
+    delete[] population.fitness;
+    delete[] population.dirty;
+    population.raw = nullptr;
+    population.fitness = nullptr;
+    population.dirty = nullptr;
+    population.data = nullptr;
+    population.size = 0;
 }
 
 
 /**
- * @brief Generates an initial population for the puzzle solver.
+ * @brief Returns the index of the calling thread inside an OpenMP parallel region.
  *
- * This function initializes a population array with a given size, where each 
- * individual in the population is a variation of the initial puzzle configuration.
+ * @return The thread index, 0 when built without OpenMP or outside a parallel region.
+ */
+static int getThreadIndex(){
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Splits [begin, end) into one contiguous block per thread of the current parallel region.
  *
- * @param population_arr A 3D array to store the generated population. The first 
- *                       dimension represents the population size, the second 
- *                       dimension represents the tiles in the puzzle, and the 
- *                       third dimension represents the size of each tile.
- * @param arr A 2D array representing the initial puzzle configuration. The first 
- *            dimension represents the tiles in the puzzle, and the second dimension 
- *            represents the size of each tile.
- * @param population_size The number of individuals in the population.
+ * Blocks start on multiples of alignment (relative to begin) so batched kernels such as
+ * evaluateFitnessBatch see whole groups; trailing threads may get an empty block.
+ *
+ * @param begin The first index of the range.
+ * @param end One past the last index of the range.
+ * @param alignment The block size granularity.
+ * @param block_start Receives the first index of the calling thread's block.
+ * @param block_end Receives one past the last index of the calling thread's block.
  */
-void generatePopulation(int*** population_arr, int** arr, int population_size, pair<mt19937, uniform_int_distribution<int>> random){
+static void getThreadBlock(int begin, int end, int alignment, int &block_start, int &block_end){
+    int thread_count = 1;
+#ifdef _OPENMP
+    thread_count = omp_get_num_threads();
+#endif
+    int block_size = (end - begin + thread_count - 1) / thread_count;
+    block_size = (block_size + alignment - 1) / alignment * alignment;
+
+    block_start = min(end, begin + getThreadIndex() * block_size);
+    block_end = min(end, block_start + block_size);
+}
 
-        int** arr_copy = allocatePuzzle();
+#ifdef EVOL_PUZZLE_COUNT_ALLOCATIONS
+static atomic<long long> allocation_count(0);
 
-        for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
-            for (int j = 0; j < TILE_SIZE; j++){
-                arr_copy[i][j] = arr[i][j];
-            }
-        }
+static void* countedAllocate(size_t size){
+    allocation_count.fetch_add(1, memory_order_relaxed);
+    void* memory = malloc(size ? size : 1);
+    if (memory == nullptr){
+        throw bad_alloc();
+    }
+    return memory;
+}
 
-        for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
-            for (int j = 0; j < TILE_SIZE; j++){
-                population_arr[0][i][j] = arr_copy[i][j];
-            }
-        }
+// every other new/delete overload forwards to these four
+void* operator new(size_t size){
+    return countedAllocate(size);
+}
 
-        #pragma omp parallel for
-        for (int i = 1; i < population_size; i++){
-            for (int j = 0; j < TILES_IN_PUZZLE_COUNT/2; j++){
-                swapTile(arr_copy, random);
-                rotateToLeftByOneIndex(arr_copy[j]);
-            }
-            
-            for (int j = 0; j < TILES_IN_PUZZLE_COUNT; j++){
-                for (int p = 0; p < TILE_SIZE; p++){
-                    population_arr[i][j][p] = arr_copy[j][p];
-                }
-            }
-        }
-        
-        freePuzzle(arr_copy);
+void* operator new[](size_t size){
+    return countedAllocate(size);
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
 }
 
+void operator delete[](void* memory) noexcept {
+    free(memory);
+}
+#endif
 
 /**
- * @brief Counts the number of edge mismatches in a given puzzle.
+ * @brief Returns the number of global operator new calls made so far.
  *
- * This function checks the mismatches between adjacent tiles in a puzzle.
- * It considers both the left and top edges of each tile and compares them
- * with the corresponding edges of the neighboring tiles.
+ * @return The allocation count, or -1 if counting was not compiled in.
+ */
+long long getAllocationCount(){
+#ifdef EVOL_PUZZLE_COUNT_ALLOCATIONS
+    return allocation_count.load(memory_order_relaxed);
+#else
+    return -1;
+#endif
+}
+
+/**
+ * @brief A range of task indices owned by one worker of runWorkStealing.
  *
- * @param puzzle A 2D array representing the puzzle, where each tile is an array of edges.
- *               The edges are assumed to be in the following order:
- *               [top, right, bottom, left].
- * @return The total number of edge mismatches in the puzzle.
+ * The begin and end of the range share one atomic word, so the owner taking a task
+ * from the front and a thief taking half from the back are both a single CAS.
  */
-int countEdgeMismatch(int** puzzle){
-    int edge_mismatch = 0;
-    
-    // checking left edge mismatch
-    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
-        if (i % 8 == 0){
-            continue;
-        }
+struct StealableRange {
+    atomic<uint64_t> range; // begin in the high 32 bits, end in the low 32 bits
+    char padding[CACHE_LINE_SIZE - sizeof(atomic<uint64_t>)];
+};
 
-        if (puzzle[i][3] != puzzle[i-1][1]){
-            edge_mismatch++;
-        }
-    }
+/**
+ * @brief Packs a [begin, end) task range into one word.
+ */
+static uint64_t packRange(uint32_t begin, uint32_t end){
+    return ((uint64_t)begin << 32) | end;
+}
 
-    // checking top edge mismatch
-    for (int i = 8; i < TILES_IN_PUZZLE_COUNT; i++){
-        if (puzzle[i][0] != puzzle[i-8][2]){
-            edge_mismatch++;
+/**
+ * @brief Takes the first task of the calling worker's own range.
+ *
+ * @param own The calling worker's range.
+ * @param task_index Receives the task index.
+ * @return False if the range is empty.
+ */
+static bool popTask(StealableRange &own, int &task_index){
+    uint64_t range = own.range.load(memory_order_acquire);
+    while (true){
+        uint32_t begin = range >> 32;
+        uint32_t end = (uint32_t)range;
+        if (begin >= end){
+            return false;
+        }
+        if (own.range.compare_exchange_weak(range, packRange(begin + 1, end), memory_order_acq_rel, memory_order_acquire)){
+            task_index = begin;
+            return true;
         }
     }
-
-    return edge_mismatch;
 }
 
 /**
- * @brief Performs a one-point crossover on two parent matrices.
- * 
- * This function takes two parent matrices and performs a one-point crossover
- * to generate new offsprings. The crossover point is chosen randomly, and the 
- * elements of the matrices are swapped at that point to create new offspring.
- * 
- * @param parent1 A pointer to the first parent matrix.
- * @param parent2 A pointer to the second parent matrix.
+ * @brief Moves the back half of a victim's range into the calling worker's empty range.
+ *
+ * @param victim The range to steal from.
+ * @param own The calling worker's range, empty on entry.
+ * @return False if the victim had nothing left.
  */
-int onePointCrossover(int** offspring1, int** offspring2){
-    // TODO: Create function to take care of random number generation and seeding
-    
-    // using a high-resolution clock to seed the random number generator
-    unsigned seed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
-    std::mt19937 generator(seed); // Mersenne Twister random number generator
-    std::uniform_int_distribution<int> distribution(0, TILES_IN_PUZZLE_COUNT - 1);
-
-    // Generate the crossover point
-    int crossover_point = distribution(generator);
-
-    // Perform one-point crossover
-    for (int i = crossover_point; i < TILES_IN_PUZZLE_COUNT; i++){
-        for (int j = 0; j < TILE_SIZE; j++){
-            int temp = offspring1[i][j];
-            offspring1[i][j] = offspring2[i][j];
-            offspring2[i][j] = temp;
+static bool stealTasks(StealableRange &victim, StealableRange &own){
+    uint64_t range = victim.range.load(memory_order_acquire);
+    while (true){
+        uint32_t begin = range >> 32;
+        uint32_t end = (uint32_t)range;
+        if (begin >= end){
+            return false;
+        }
+        uint32_t split = end - (end - begin + 1) / 2;
+        if (victim.range.compare_exchange_weak(range, packRange(begin, split), memory_order_acq_rel, memory_order_acquire)){
+            own.range.store(packRange(split, end), memory_order_release);
+            return true;
         }
     }
-
-    return crossover_point;
 }
 
-
+/**
+ * @brief Runs task(0..task_count-1) on the OpenMP threads with work stealing.
+ *
+ * Every thread starts with a contiguous block of task indices and takes tasks from its
+ * front; a thread that runs out steals the back half of another thread's remaining
+ * block, so uneven task costs stay balanced without a shared queue. Tasks never spawn
+ * tasks, so a thread that finds every other block empty is done. Without OpenMP the
+ * tasks run in order on the calling thread.
+ *
+ * @param task_count The number of tasks.
+ * @param task The task body, called with the task index and context.
+ * @param context Passed through to every task.
+ * @return The number of successful steals.
+ */
+int runWorkStealing(int task_count, void (*task)(int task_index, void* context), void* context){
+    int steal_count = 0;
+    int max_thread_count = 1;
+#ifdef _OPENMP
+    // inside an island thread a nested region would only get one thread anyway
+    if (omp_get_active_level() < omp_get_max_active_levels()){
+        max_thread_count = omp_get_max_threads();
+    }
+#endif
+    if (max_thread_count == 1 || task_count <= 1){
+        for (int i = 0; i < task_count; i++){
+            task(i, context);
+        }
+        return 0;
+    }
+
+    // kept per calling thread and only ever grown, so steady-state generations do not allocate
+    static thread_local unique_ptr<StealableRange[]> range_buffer;
+    static thread_local int range_capacity = 0;
+    if (range_capacity < max_thread_count){
+        range_buffer.reset(new StealableRange[max_thread_count]);
+        range_capacity = max_thread_count;
+    }
+    // the workers have to share the calling thread's buffer, not their own thread_local one
+    StealableRange* ranges = range_buffer.get();
+
+    #pragma omp parallel reduction(+:steal_count)
+    {
+        int thread_count = 1;
+#ifdef _OPENMP
+        thread_count = omp_get_num_threads();
+#endif
+        int thread_index = getThreadIndex();
+        int block_start, block_end;
+        getThreadBlock(0, task_count, 1, block_start, block_end);
+        ranges[thread_index].range.store(packRange(block_start, block_end), memory_order_release);
+
+        // every range has to be published before anyone tries to steal
+        #pragma omp barrier
+
+        int task_index;
+        while (true){
+            if (popTask(ranges[thread_index], task_index)){
+                task(task_index, context);
+                continue;
+            }
+
+            bool stolen = false;
+            for (int k = 1; k < thread_count && !stolen; k++){
+                stolen = stealTasks(ranges[(thread_index + k) % thread_count], ranges[thread_index]);
+            }
+            if (!stolen){
+                break;
+            }
+            steal_count++;
+        }
+    }
+    return steal_count;
+}
+
+/**
+ * @brief Generates an initial population for the puzzle solver.
+ *
+ * This function initializes a population array with a given size, where each 
+ * individual in the population is a variation of the initial puzzle configuration.
+ *
+ * @param population_arr The population to store the generated individuals in.
+ * @param arr The initial puzzle configuration.
+ * @param population_size The number of individuals in the population.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::generatePopulation(Population &population_arr, Puzzle arr, int population_size, Rng &rng){
+
+        copyPuzzle(arr, population_arr[0]);
+
+        // the caller's stream only seeds the per-thread streams, so restarts still differ
+        uint64_t seed = nextRandom(rng);
+
+        #pragma omp parallel
+        {
+            // each thread shuffles its own copy of the input puzzle into a contiguous block
+            int block_start, block_end;
+            getThreadBlock(1, population_size, 1, block_start, block_end);
+
+            Rng thread_rng = makeRng(seed, getThreadIndex());
+            Gene arr_copy[TILES_IN_PUZZLE_COUNT];
+            copyPuzzle(arr, arr_copy);
+
+            for (int i = block_start; i < block_end; i++){
+                for (int j = 0; j < TILES_IN_PUZZLE_COUNT/2; j++){
+                    swapTile(arr_copy, thread_rng);
+                    rotateGene(arr_copy[j]);
+                }
+
+                copyPuzzle(arr_copy, population_arr[i]);
+            }
+        }
+
+        fill(population_arr.dirty, population_arr.dirty + population_size, true);
+}
+
+
+/**
+ * @brief Groups the genes of every input tile in every rotation by their top and left motifs.
+ *
+ * A counting sort on the (top, left) pair of every gene, so each group keeps the genes
+ * in increasing order.
+ *
+ * @param edge_table The edge table built from the input puzzle.
+ * @return The candidate index.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+typename EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::CandidateIndex EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::buildCandidateIndex(const EdgeTable &edge_table){
+    CandidateIndex candidate_index;
+    int group_size[MOTIF_COUNT * MOTIF_COUNT] = {0};
+    for (int t = 0; t < TILES_IN_PUZZLE_COUNT; t++){
+        for (int r = 0; r < TILE_SIZE; r++){
+            group_size[edge_table.edges[t][r][TOP] * MOTIF_COUNT + edge_table.edges[t][r][LEFT]]++;
+        }
+    }
+
+    candidate_index.start[0] = 0;
+    for (int group = 0; group < MOTIF_COUNT * MOTIF_COUNT; group++){
+        candidate_index.start[group + 1] = candidate_index.start[group] + group_size[group];
+        group_size[group] = candidate_index.start[group];
+    }
+
+    for (int t = 0; t < TILES_IN_PUZZLE_COUNT; t++){
+        for (int r = 0; r < TILE_SIZE; r++){
+            int group = edge_table.edges[t][r][TOP] * MOTIF_COUNT + edge_table.edges[t][r][LEFT];
+            candidate_index.genes[group_size[group]++] = makeGene(t, r);
+        }
+    }
+    return candidate_index;
+}
+
+/**
+ * @brief Appends the genes of one candidate group whose tile is still unused.
+ *
+ * @return The new number of candidates.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::collectCandidates(const CandidateIndex &candidate_index, int top, int left, const bool* used, Gene* candidates, int candidate_count){
+    int group = top * MOTIF_COUNT + left;
+    for (int k = candidate_index.start[group]; k < candidate_index.start[group + 1]; k++){
+        Gene gene = candidate_index.genes[k];
+        candidates[candidate_count] = gene;
+        candidate_count += !used[getGeneTile(gene)];
+    }
+    return candidate_count;
+}
+
+/**
+ * @brief Builds a puzzle with a randomized greedy (GRASP) construction.
+ *
+ * Positions are filled in row order, so the only placed neighbours of a position are
+ * above and on the left. The restricted candidate list holds the unused genes that
+ * match both of them; if there are none, the ones matching one of them; if there are
+ * none either, every unused tile in every rotation. A candidate is drawn uniformly
+ * from that list.
+ *
+ * @param puzzle Receives the puzzle.
+ * @param candidate_index The candidate index built from the input puzzle.
+ * @param edge_table The edge table built from the input puzzle.
+ * @param rng The random stream used to pick among the candidates.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::greedyConstruct(Puzzle puzzle, const CandidateIndex &candidate_index, const EdgeTable &edge_table, Rng &rng){
+    bool used[TILES_IN_PUZZLE_COUNT] = {false};
+    Gene candidates[TILES_IN_PUZZLE_COUNT * TILE_SIZE];
+
+    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+        int top = i >= PUZZLE_WIDTH ? getGeneEdge(edge_table, puzzle[i - PUZZLE_WIDTH], BOTTOM) : -1;
+        int left = i % PUZZLE_WIDTH > 0 ? getGeneEdge(edge_table, puzzle[i - 1], RIGHT) : -1;
+
+        int candidate_count = 0;
+        if (top >= 0 && left >= 0){
+            candidate_count = collectCandidates(candidate_index, top, left, used, candidates, candidate_count);
+        }
+        // no gene matches both sides (or there is only one), settle for one side
+        if (candidate_count == 0){
+            for (int motif = 0; motif < MOTIF_COUNT; motif++){
+                if (left >= 0){
+                    candidate_count = collectCandidates(candidate_index, motif, left, used, candidates, candidate_count);
+                }
+                if (top >= 0 && motif != left){
+                    candidate_count = collectCandidates(candidate_index, top, motif, used, candidates, candidate_count);
+                }
+            }
+        }
+        if (candidate_count == 0){
+            for (int t = 0; t < TILES_IN_PUZZLE_COUNT; t++){
+                for (int r = 0; r < TILE_SIZE && !used[t]; r++){
+                    candidates[candidate_count++] = makeGene(t, r);
+                }
+            }
+        }
+
+        Gene gene = candidates[randomBelow(rng, candidate_count)];
+        used[getGeneTile(gene)] = true;
+        puzzle[i] = gene;
+    }
+}
+
+/**
+ * @brief Generates an initial population with greedyConstruct.
+ *
+ * @param population_arr The population to store the generated individuals in.
+ * @param population_size The number of individuals in the population.
+ * @param edge_table The edge table built from the input puzzle.
+ * @param rng The random stream the per-thread streams are derived from.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::generateGreedyPopulation(Population &population_arr, int population_size, const EdgeTable &edge_table, Rng &rng){
+    const CandidateIndex candidate_index = buildCandidateIndex(edge_table);
+    uint64_t seed = nextRandom(rng);
+
+    #pragma omp parallel
+    {
+        int block_start, block_end;
+        getThreadBlock(0, population_size, 1, block_start, block_end);
+
+        Rng thread_rng = makeRng(seed, getThreadIndex());
+        for (int i = block_start; i < block_end; i++){
+            greedyConstruct(population_arr[i], candidate_index, edge_table, thread_rng);
+        }
+    }
+
+    fill(population_arr.dirty, population_arr.dirty + population_size, true);
+}
+
+/**
+ * @brief Generates the first population of a run with the given method.
+ *
+ * @param population_arr The population to store the generated individuals in.
+ * @param puzzle The input puzzle, used by RANDOM_INITIALIZATION.
+ * @param population_size The number of individuals in the population.
+ * @param edge_table The edge table built from the input puzzle.
+ * @param rng The random stream of the run.
+ * @param initialization_method generatePopulation or generateGreedyPopulation.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::initializePopulation(Population &population_arr, Puzzle puzzle, int population_size, const EdgeTable &edge_table, Rng &rng, InitializationMethod initialization_method){
+    if (initialization_method == GREEDY_INITIALIZATION){
+        generateGreedyPopulation(population_arr, population_size, edge_table, rng);
+    } else {
+        generatePopulation(population_arr, puzzle, population_size, rng);
+    }
+}
+
+
+/**
+ * @brief Counts the number of edge mismatches in a given puzzle, one edge at a time.
+ *
+ * This function checks the mismatches between adjacent tiles in a puzzle.
+ * It considers both the left and top edges of each tile and compares them
+ * with the corresponding edges of the neighboring tiles.
+ *
+ * @param puzzle The puzzle to score.
+ * @param edge_table The edge table giving the [top, right, bottom, left] motifs of each gene.
+ * @return The total number of edge mismatches in the puzzle.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::countEdgeMismatchScalar(const Gene* puzzle, const EdgeTable &edge_table){
+    int edge_mismatch = 0;
+    
+    // checking left edge mismatch
+    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+        if (i % PUZZLE_WIDTH == 0){
+            continue;
+        }
+
+        if (getGeneEdge(edge_table, puzzle[i], LEFT) != getGeneEdge(edge_table, puzzle[i-1], RIGHT)){
+            edge_mismatch++;
+        }
+    }
+
+    // checking top edge mismatch
+    for (int i = PUZZLE_WIDTH; i < TILES_IN_PUZZLE_COUNT; i++){
+        if (getGeneEdge(edge_table, puzzle[i], TOP) != getGeneEdge(edge_table, puzzle[i-PUZZLE_WIDTH], BOTTOM)){
+            edge_mismatch++;
+        }
+    }
+
+    return edge_mismatch;
+}
+
+#ifdef EVOL_PUZZLE_X86_DISPATCH
+
+/**
+ * @brief Counts the number of edge mismatches in a given puzzle with AVX2.
+ *
+ * A row of the puzzle is exactly 8 positions, so each row is one 256-bit vector
+ * of 8 lanes. The packed [top, right, bottom, left] edges of each lane are gathered
+ * straight from the edge table (edges[t][r] is 4 bytes, indexed by the gene).
+ * The right-edge plane is shifted one lane to line up with the left-edge plane of
+ * the same row, and the bottom-edge plane of each row is compared with the top-edge
+ * plane of the next one. Mismatching lanes are collected with movemask and counted
+ * with popcount.
+ *
+ * Only call this when hasAVX2() is true.
+ *
+ * @param puzzle The puzzle to score.
+ * @param edge_table The edge table giving the [top, right, bottom, left] motifs of each gene.
+ * @return The total number of edge mismatches in the puzzle.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+__attribute__((target("avx2")))
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::countEdgeMismatchAVX2(const Gene* puzzle, const EdgeTable &edge_table){
+    if (!HAS_AVX2_KERNELS){
+        return countEdgeMismatchScalar(puzzle, edge_table);
+    }
+
+    const int* packed_edges = reinterpret_cast<const int*>(edge_table.edges);
+    const __m256i motif_mask = _mm256_set1_epi32(EDGE_MASK);
+    const __m256i previous_lane = _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6);
+    // the first column has no left neighbour
+    const int left_edge_lanes = 0xFE;
+
+    int edge_mismatch = 0;
+    __m256i previous_bottom = _mm256_setzero_si256();
+
+    for (int row = 0; row < TILES_IN_PUZZLE_COUNT / 8; row++){
+        __m128i genes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(puzzle + row * 8));
+        __m256i edges = _mm256_i32gather_epi32(packed_edges, _mm256_cvtepu8_epi32(genes), 4);
+
+        __m256i top = _mm256_and_si256(edges, motif_mask);
+        __m256i right = _mm256_and_si256(_mm256_srli_epi32(edges, 8 * RIGHT), motif_mask);
+        __m256i bottom = _mm256_and_si256(_mm256_srli_epi32(edges, 8 * BOTTOM), motif_mask);
+        __m256i left = _mm256_srli_epi32(edges, 8 * LEFT);
+
+        // checking left edge mismatch
+        __m256i left_neighbour_right = _mm256_permutevar8x32_epi32(right, previous_lane);
+        int left_matches = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(left, left_neighbour_right)));
+        edge_mismatch += __builtin_popcount(~left_matches & left_edge_lanes);
+
+        // checking top edge mismatch
+        if (row > 0){
+            int top_matches = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(top, previous_bottom)));
+            edge_mismatch += __builtin_popcount(~top_matches & 0xFF);
+        }
+        previous_bottom = bottom;
+    }
+
+    return edge_mismatch;
+}
+
+/**
+ * @brief Scores a range of individuals 8 at a time with AVX2, one individual per lane.
+ *
+ * For each block of 8 individuals and each row, the 8 rows of 8 genes are transposed
+ * with byte/word/dword unpacks so that lane k of every vector belongs to individual k
+ * and vector c holds column c. Edges are then gathered per column and compared with
+ * the right edges of the previous column and the bottom edges of the same column in
+ * the previous row, accumulating matches lane-wise with no horizontal reduction.
+ * Individuals left over after the last full block are scored with countEdgeMismatch.
+ *
+ * Only call this when hasAVX2() is true.
+ *
+ * @param population_arr The population of puzzle solutions.
+ * @param start_index The first individual to score.
+ * @param end_index One past the last individual to score.
+ * @param edge_table The edge table built from the input puzzle.
+ * @param fitness_arr Receives the edge mismatch count of individual i at index i.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+__attribute__((target("avx2")))
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::evaluateFitnessBatchAVX2(const Population &population_arr, const int start_index, const int end_index, const EdgeTable &edge_table, int* fitness_arr){
+    const int* packed_edges = reinterpret_cast<const int*>(edge_table.edges);
+    const __m256i motif_mask = _mm256_set1_epi32(EDGE_MASK);
+    const __m256i max_edge_mismatch = _mm256_set1_epi32(MAX_EDGE_MISMATCH_COUNT);
+    const int lanes = 8;
+
+    int i = start_index;
+    for (; i + lanes <= end_index; i += lanes){
+        // counts matching edges, cmpeq gives -1 per matching lane
+        __m256i matches = _mm256_setzero_si256();
+        __m256i previous_bottom[8];
+
+        for (int row = 0; row < 8; row++){
+            __m128i rows[8];
+            for (int k = 0; k < lanes; k++){
+                rows[k] = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(population_arr[i + k] + row * 8));
+            }
+
+            // 8x8 byte transpose: columns[c / 2] holds column c of the 8 individuals in its low (c even) or high (c odd) 8 bytes
+            __m128i pairs0 = _mm_unpacklo_epi8(rows[0], rows[1]);
+            __m128i pairs1 = _mm_unpacklo_epi8(rows[2], rows[3]);
+            __m128i pairs2 = _mm_unpacklo_epi8(rows[4], rows[5]);
+            __m128i pairs3 = _mm_unpacklo_epi8(rows[6], rows[7]);
+            __m128i quads0 = _mm_unpacklo_epi16(pairs0, pairs1);
+            __m128i quads1 = _mm_unpackhi_epi16(pairs0, pairs1);
+            __m128i quads2 = _mm_unpacklo_epi16(pairs2, pairs3);
+            __m128i quads3 = _mm_unpackhi_epi16(pairs2, pairs3);
+            __m128i columns[4] = {
+                _mm_unpacklo_epi32(quads0, quads2),
+                _mm_unpackhi_epi32(quads0, quads2),
+                _mm_unpacklo_epi32(quads1, quads3),
+                _mm_unpackhi_epi32(quads1, quads3)
+            };
+
+            __m256i previous_right = _mm256_setzero_si256();
+            for (int col = 0; col < 8; col++){
+                __m128i genes = col % 2 == 0 ? columns[col / 2] : _mm_srli_si128(columns[col / 2], 8);
+                __m256i edges = _mm256_i32gather_epi32(packed_edges, _mm256_cvtepu8_epi32(genes), 4);
+
+                __m256i top = _mm256_and_si256(edges, motif_mask);
+                __m256i right = _mm256_and_si256(_mm256_srli_epi32(edges, 8 * RIGHT), motif_mask);
+                __m256i bottom = _mm256_and_si256(_mm256_srli_epi32(edges, 8 * BOTTOM), motif_mask);
+                __m256i left = _mm256_srli_epi32(edges, 8 * LEFT);
+
+                if (col > 0){
+                    matches = _mm256_sub_epi32(matches, _mm256_cmpeq_epi32(left, previous_right));
+                }
+                if (row > 0){
+                    matches = _mm256_sub_epi32(matches, _mm256_cmpeq_epi32(top, previous_bottom[col]));
+                }
+                previous_right = right;
+                previous_bottom[col] = bottom;
+            }
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(fitness_arr + i), _mm256_sub_epi32(max_edge_mismatch, matches));
+    }
+
+    for (; i < end_index; i++){
+        fitness_arr[i] = countEdgeMismatch(population_arr[i], edge_table);
+    }
+}
+
+/**
+ * @brief Returns whether the CPU running the program supports AVX2.
+ */
+bool hasAVX2(){
+    // may run during static initialization, before the CPU model is filled in
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+#else
+
+// without x86 intrinsics the AVX2 kernel is the scalar one and is never selected
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::countEdgeMismatchAVX2(const Gene* puzzle, const EdgeTable &edge_table){
+    return countEdgeMismatchScalar(puzzle, edge_table);
+}
+
+bool hasAVX2(){
+    return false;
+}
+
+#endif
+
+/**
+ * @brief Picks the fastest edge mismatch kernel supported by the CPU.
+ *
+ * @return countEdgeMismatchAVX2 when AVX2 is available and the puzzle is 8x8, countEdgeMismatchScalar otherwise.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+typename EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::EdgeMismatchKernel EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::selectEdgeMismatchKernel(){
+    return HAS_AVX2_KERNELS && hasAVX2() ? countEdgeMismatchAVX2 : countEdgeMismatchScalar;
+}
+
+template<int WIDTH, int HEIGHT, int MOTIFS>
+const typename EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::EdgeMismatchKernel EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::edge_mismatch_kernel = selectEdgeMismatchKernel();
+
+/**
+ * @brief Scores a range of individuals and writes their fitness into a preallocated array.
+ *
+ * With AVX2 and an 8x8 puzzle the individuals are scored 8 at a time in a transposed layout where lane k
+ * of every vector belongs to individual k, which keeps the SIMD units busy and removes
+ * the per-individual call and reduction overhead. Otherwise each individual is scored
+ * with countEdgeMismatch.
+ *
+ * @param population_arr The population of puzzle solutions.
+ * @param start_index The first individual to score.
+ * @param end_index One past the last individual to score.
+ * @param edge_table The edge table built from the input puzzle.
+ * @param fitness_arr Receives the edge mismatch count of individual i at index i.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::evaluateFitnessBatch(const Population &population_arr, const int start_index, const int end_index, const EdgeTable &edge_table, int* fitness_arr){
+#ifdef EVOL_PUZZLE_X86_DISPATCH
+    if (HAS_AVX2_KERNELS && hasAVX2()){
+        evaluateFitnessBatchAVX2(population_arr, start_index, end_index, edge_table, fitness_arr);
+        return;
+    }
+#endif
+    for (int i = start_index; i < end_index; i++){
+        fitness_arr[i] = countEdgeMismatch(population_arr[i], edge_table);
+    }
+}
+
+/**
+ * @brief Rescores the individuals whose cached fitness is marked dirty.
+ *
+ * Consecutive dirty individuals are scored together with evaluateFitnessBatch,
+ * so a fully regenerated population is scored in one batched pass.
+ *
+ * @param population_arr The population whose cache is refreshed.
+ * @param POPULATION_SIZE The number of individuals in the population.
+ * @param edge_table The edge table built from the input puzzle.
+ * @return The number of individuals that were rescored.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::refreshFitness(Population &population_arr, const int POPULATION_SIZE, const EdgeTable &edge_table){
+    int rescored_count = 0;
+
+    // each thread scans its own block, aligned to the 8-individual batches
+    #pragma omp parallel reduction(+:rescored_count)
+    {
+        int block_start, block_end;
+        getThreadBlock(0, POPULATION_SIZE, 8, block_start, block_end);
+
+        int i = block_start;
+        while (i < block_end){
+            if (!population_arr.dirty[i]){
+                i++;
+                continue;
+            }
+
+            int run_end = i + 1;
+            while (run_end < block_end && population_arr.dirty[run_end]){
+                run_end++;
+            }
+            evaluateFitnessBatch(population_arr, i, run_end, edge_table, population_arr.fitness);
+            fill(population_arr.dirty + i, population_arr.dirty + run_end, false);
+
+            rescored_count += run_end - i;
+            i = run_end;
+        }
+    }
+    return rescored_count;
+}
+
+/**
+ * @brief Counts the number of edge mismatches in a given puzzle.
+ *
+ * This function checks the mismatches between adjacent tiles in a puzzle,
+ * using the kernel selected once at startup from the CPU features (see
+ * countEdgeMismatchAVX2 and countEdgeMismatchScalar).
+ *
+ * @param puzzle The puzzle to score.
+ * @param edge_table The edge table giving the [top, right, bottom, left] motifs of each gene.
+ * @return The total number of edge mismatches in the puzzle.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::countEdgeMismatch(const Gene* puzzle, const EdgeTable &edge_table){
+    return edge_mismatch_kernel(puzzle, edge_table);
+}
+
+/**
+ * @brief Performs a one-point crossover on two parent matrices.
+ * 
+ * This function takes two parent matrices and performs a one-point crossover
+ * to generate new offsprings. The crossover point is chosen randomly, and the 
+ * elements of the matrices are swapped at that point to create new offspring.
+ * 
+ * @param parent1 A pointer to the first parent matrix.
+ * @param parent2 A pointer to the second parent matrix.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::onePointCrossover(Puzzle offspring1, Puzzle offspring2, Rng &rng){
+    // Generate the crossover point
+    int crossover_point = randomTileIndex(rng);
+
+    // Perform one-point crossover
+    for (int i = crossover_point; i < TILES_IN_PUZZLE_COUNT; i++){
+        Gene temp = offspring1[i];
+        offspring1[i] = offspring2[i];
+        offspring2[i] = temp;
+    }
+
+    return crossover_point;
+}
+
+
 /**
  * @brief Performs a two-point crossover on two parent matrices.
  *
  * This function takes two parent matrices and performs a two-point crossover
- * to generate new offsprings. The crossover points are randomly selected using
- * a high-resolution clock to seed the random number generator. The elements
- * between the two crossover points are swapped between the two parents.
+ * to generate new offsprings. The crossover points are drawn from the caller's
+ * random stream. The elements between the two crossover points are swapped
+ * between the two parents.
  *
  * @param parent1 A pointer to the first parent matrix.
  * @param parent2 A pointer to the second parent matrix.
  */
-pair<int, int>  twoPointCrossover(int** offspring1, int** offspring2){
-    // using a high-resolution clock to seed the random number generator
-    unsigned seed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
-    std::mt19937 generator(seed); // Mersenne Twister random number generator
-    std::uniform_int_distribution<int> distribution(0, TILES_IN_PUZZLE_COUNT - 1);
-
+template<int WIDTH, int HEIGHT, int MOTIFS>
+pair<int, int>  EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::twoPointCrossover(Puzzle offspring1, Puzzle offspring2, Rng &rng){
     // Generate the crossover points
-    int crossover_point1 = distribution(generator);
-    int crossover_point2 = distribution(generator);
+    int crossover_point1 = randomTileIndex(rng);
+    int crossover_point2 = randomTileIndex(rng);
 
     // Ensure CrossoverPoint1 < CrossoverPoint2
     if (crossover_point1 > crossover_point2){
@@ -623,226 +1493,1974 @@ pair<int, int>  twoPointCrossover(int** offspring1, int** offspring2){
 
     // Perform two-point crossover
     for (int i = crossover_point1; i <= crossover_point2; i++){
-        for (int j = 0; j < TILE_SIZE; j++){
-            int temp = offspring1[i][j];
-            offspring1[i][j] = offspring2[i][j];
-            offspring2[i][j] = temp;
+        Gene temp = offspring1[i];
+        offspring1[i] = offspring2[i];
+        offspring2[i] = temp;
+    }
+
+    return make_pair(crossover_point1, crossover_point2);
+}
+
+/**
+ * @brief Performs an order crossover (OX) on two offspring.
+ *
+ * The genes between two random crossover points are exchanged between the offspring,
+ * and the remaining positions of each offspring are filled, starting after the second
+ * crossover point, with the tiles of its own parent that are not already placed, in
+ * the order they appear in that parent. Tiles keep the rotation they had in the parent
+ * they are copied from, so both offspring remain permutations of the input tiles.
+ *
+ * @param offspring1 The first offspring, holding a copy of the first parent on entry.
+ * @param offspring2 The second offspring, holding a copy of the second parent on entry.
+ * @param rng The random stream used to pick the crossover points.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::orderCrossover(Puzzle offspring1, Puzzle offspring2, Rng &rng){
+
+    Gene parent1[TILES_IN_PUZZLE_COUNT];
+    Gene parent2[TILES_IN_PUZZLE_COUNT];
+    copyPuzzle(offspring1, parent1);
+    copyPuzzle(offspring2, parent2);
+
+    // input tiles already placed in each offspring, indexed by tile index
+    bool placed1[TILES_IN_PUZZLE_COUNT] = {false};
+    bool placed2[TILES_IN_PUZZLE_COUNT] = {false};
+
+    // Generate the crossover points
+    int crossover_point1 = randomTileIndex(rng);
+    int crossover_point2 = randomTileIndex(rng);
+
+    // Ensure CrossoverPoint1 < CrossoverPoint2
+    if (crossover_point1 > crossover_point2){
+        int temp = crossover_point1;
+        crossover_point1 = crossover_point2;
+        crossover_point2 = temp;
+    }
+    
+    // Perform two-point crossover
+    for (int i = crossover_point1; i < crossover_point2; i++){
+        copyTile(parent1[i], offspring2[i]);
+        copyTile(parent2[i], offspring1[i]);
+        placed2[getGeneTile(parent1[i])] = true;
+        placed1[getGeneTile(parent2[i])] = true;
+    }
+
+    //copy what is not between crossover points from parent2 to offspring2
+    int count_limit = TILES_IN_PUZZLE_COUNT - (crossover_point2 - crossover_point1);
+    for (int i = crossover_point2, j = i, count = 0; count < count_limit; i = (i + 1) % TILES_IN_PUZZLE_COUNT){
+        if (!placed2[getGeneTile(parent2[i])]){
+            copyTile(parent2[i], offspring2[j]);
+            placed2[getGeneTile(parent2[i])] = true;
+            j = (j + 1) % TILES_IN_PUZZLE_COUNT;
+            count++;
+        }
+    }
+
+    //copy what is not between crossover points from parent1 to offspring1
+    for (int i = crossover_point2, j = i, count = 0; count < count_limit; i = (i + 1) % TILES_IN_PUZZLE_COUNT){
+        if (!placed1[getGeneTile(parent1[i])]){
+            copyTile(parent1[i], offspring1[j]);
+            placed1[getGeneTile(parent1[i])] = true;
+            j = (j + 1) % TILES_IN_PUZZLE_COUNT;
+            count++;
+        }
+    }
+}
+
+/**
+ * @brief Evolves a population of solutions over a specified number of generations.
+ *
+ * This function performs genetic algorithm operations such as crossover and mutation
+ * on a population of solutions. It evaluates the fitness of the population after each
+ * generation and tracks the minimum edge mismatch count.
+ *
+ * @param population_arr The population of solutions.
+ * @param NUM_OF_GENERATIONS The number of generations to evolve the population.
+ * @param POPULATION_SIZE The size of the population.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::evolve(Population &population_arr, int NUM_OF_GENERATIONS, const int POPULATION_SIZE, const EdgeTable &edge_table, Rng &rng, bool print_flag, Island* island, SelectionMethod selection_method, LocalSearchMethod local_search_method, long long completion_node_limit){
+    int min_edge_mismatch_count = INT_MAX;
+    int generations_performed = 1;
+    int stagnated_generation_count = 0;
+    int stagnation_threshold = 1000;
+    stagnation_threshold = max(10, (stagnation_threshold/POPULATION_SIZE) * stagnation_threshold);
+    const int MAX_MUTATION_RATE = 32;
+    const int MAX_MISMATCH = MAX_EDGE_MISMATCH_COUNT;
+    int mutation_rate = MAX_MUTATION_RATE;
+    float ratio = 0.25;
+    int ratio_adjusted_pop_size = POPULATION_SIZE * ratio;
+    ratio_adjusted_pop_size = ratio_adjusted_pop_size % 2 == 0 ? ratio_adjusted_pop_size : ratio_adjusted_pop_size + 1;
+    Puzzle best_puzzle_so_far = allocatePuzzle();
+    int current_edge_mismatch = min_edge_mismatch_count;
+    int last_gen_best_edge_mismatch = INT_MAX;
+    int restart_count = 0;
+
+    // reused every generation so ranking and selection do not allocate
+    vector<pair<int, int>> sorted_index_by_fitness_vec(POPULATION_SIZE);
+    vector<int> parent_index_vec(ratio_adjusted_pop_size);
+    vector<int> worst_index_vec(ratio_adjusted_pop_size);
+    ParentSelector select_parents = getParentSelector(selection_method);
+    vector<uint8_t> excluded(POPULATION_SIZE, 0);
+    vector<double> wheel;
+    
+    // creating lookup table for variable mismatch_rate based on edge mismatch count
+    int mutation_rate_lut[MAX_MISMATCH];
+    float inverse_max_mismatch = 1.0f/MAX_MISMATCH;
+    for (int i = 0; i < MAX_MISMATCH; i++){
+        mutation_rate_lut[i] = max(3, (int)(i * inverse_max_mismatch * MAX_MUTATION_RATE));
+    }
+
+    //while (min_edge_mismatch_count != 0){
+    while (generations_performed <= NUM_OF_GENERATIONS){
+        long long generation_start_allocation_count = getAllocationCount();
+
+        // Step 2: Evaluate Fitness (only individuals rebuilt since the last generation are rescored)
+        refreshFitness(population_arr, POPULATION_SIZE, edge_table);
+
+        // truncation and migration need the ranking; the other selection methods only need the worst and the best
+        bool migrating = island != nullptr && generations_performed % island->group->migration_interval == 0;
+        bool ranked = select_parents == nullptr || migrating;
+        int best_index;
+        if (ranked){
+            evaluateFitness(population_arr, POPULATION_SIZE, ratio_adjusted_pop_size, sorted_index_by_fitness_vec); //<index, edgeMismatchCount>
+        } else {
+            best_index = selectWorstUnranked(population_arr, POPULATION_SIZE, ratio_adjusted_pop_size, worst_index_vec);
+        }
+
+        if (island != nullptr){
+            if (island->group->solved.load(memory_order_relaxed)){
+                break;
+            }
+            if (migrating){
+                migrate(population_arr, POPULATION_SIZE, ratio_adjusted_pop_size, sorted_index_by_fitness_vec, *island, rng);
+            }
+        }
+        if (ranked){
+            best_index = sorted_index_by_fitness_vec.back().first;
+        }
+        int best_edge_mismatch = population_arr.fitness[best_index];
+
+        // a near-solved best individual is handed to the exact search when it improves, and again while it stalls
+        if (shouldCompleteExact(best_edge_mismatch, min_edge_mismatch_count, stagnated_generation_count, completion_node_limit)){
+            long long node_count;
+            if (completeExact(population_arr[best_index], edge_table, completion_node_limit, node_count)){
+                population_arr.fitness[best_index] = 0;
+                best_edge_mismatch = 0;
+            }
+        }
+
+        if (best_edge_mismatch < min_edge_mismatch_count){
+            copyPuzzle(population_arr[best_index], best_puzzle_so_far);
+            
+            if (print_flag){
+                printPuzzle(best_puzzle_so_far, edge_table);
+            }
+
+            if (best_edge_mismatch <= 25){
+                // islands share the output directory and savePuzzle's localtime
+                #pragma omp critical(save_puzzle)
+                savePuzzle(best_puzzle_so_far, edge_table, best_edge_mismatch);
+            }
+            stagnated_generation_count = 0;
+        }
+
+        // when fitness plateaus, will regenerate population with the best puzzle so far as the seed
+        if (++stagnated_generation_count == stagnation_threshold || stagnated_generation_count == stagnation_threshold * 10 || stagnated_generation_count == stagnation_threshold * 100){
+            generatePopulation(population_arr, best_puzzle_so_far, POPULATION_SIZE, rng);
+            restart_count++;
+            if (stagnated_generation_count == stagnation_threshold * 100){
+                stagnated_generation_count = 0;
+            }
+        }
+
+        min_edge_mismatch_count = min(min_edge_mismatch_count, best_edge_mismatch);
+        
+        // dynamically changing mutation_rate
+        if (best_edge_mismatch != last_gen_best_edge_mismatch){
+            last_gen_best_edge_mismatch = best_edge_mismatch;
+            mutation_rate = mutation_rate_lut[min(last_gen_best_edge_mismatch, MAX_MISMATCH - 1)];
+        }
+
+        // Step 3: Termination Criteria (either best solution found or all generations elapsed)
+        if (min_edge_mismatch_count == 0){
+            if (island != nullptr){
+                island->group->solved.store(true, memory_order_relaxed);
+            }
+            break;
+        }
+        
+        // Step 4: Select Parents
+        if (select_parents == nullptr){
+            selectParentsAndWorst(population_arr, POPULATION_SIZE, sorted_index_by_fitness_vec, ratio_adjusted_pop_size, parent_index_vec, worst_index_vec);
+        } else {
+            if (ranked){
+                for (int i = 0; i < ratio_adjusted_pop_size; i++){
+                    worst_index_vec[i] = sorted_index_by_fitness_vec[i].first;
+                }
+            }
+            // offspring are built over the worst, so those cannot be parents
+            for (int i = 0; i < ratio_adjusted_pop_size; i++){
+                excluded[worst_index_vec[i]] = 1;
+            }
+            select_parents(population_arr, POPULATION_SIZE, excluded, parent_index_vec, wheel, rng);
+            for (int i = 0; i < ratio_adjusted_pop_size; i++){
+                excluded[worst_index_vec[i]] = 0;
+            }
+        }
+
+        // Step 5 and 6: Offspring generation and Survivor Selection
+        // offspring are built and mutated straight in the slots of the worst individuals they replace
+        crossover(population_arr, POPULATION_SIZE, parent_index_vec, worst_index_vec, best_edge_mismatch, rng);
+        mutate(population_arr, worst_index_vec, edge_table, rng, mutation_rate);
+        if (best_edge_mismatch <= LOCAL_SEARCH_THRESHOLD){
+            localSearch(population_arr, worst_index_vec, edge_table, local_search_method);
+        }
+
+        if (print_flag){
+            cout << "GEN " << generations_performed << " " << " edge mismatch: "  << best_edge_mismatch \
+            << " ... mutation rate: " << mutation_rate << " ... lowest edge mismatch: " << min_edge_mismatch_count;
+            if (generation_start_allocation_count >= 0){
+                cout << " ... allocations: " << getAllocationCount() - generation_start_allocation_count;
+            }
+            cout << endl;
+        }
+        
+        generations_performed++;
+    }
+    if (island != nullptr){
+        copyPuzzle(best_puzzle_so_far, island->best_puzzle);
+        island->best_edge_mismatch = min_edge_mismatch_count;
+        island->restart_count = restart_count;
+    } else {
+        cout << "\n\nBest Puzzle with " << min_edge_mismatch_count << " edge mismatches:\n";
+        printPuzzle(best_puzzle_so_far, edge_table);
+    }
+    freePuzzle(best_puzzle_so_far);
+}
+
+/**
+ * @brief Applies alternating random swaps and rotations to a puzzle without scoring them.
+ *
+ * @param puzzle The puzzle.
+ * @param move_count The number of moves, starting with a swap.
+ * @param rng The random stream the moves are drawn from.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::applyRandomMoves(Puzzle puzzle, int move_count, Rng &rng){
+    for (int j = 0; j < move_count; j++){
+        if(j % 2 == 0) {
+            swapTile(puzzle, rng);
+        } else {
+            rotateGene(puzzle[randomTileIndex(rng)]);
+        }
+    }
+}
+
+/**
+ * @brief Buckets every individual of a population by its cached fitness.
+ *
+ * @param population_arr The population, with every cached fitness up to date.
+ * @param POPULATION_SIZE The size of the population.
+ * @param buckets Receives the buckets; their storage is reused across calls.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::buildFitnessBuckets(const Population &population_arr, const int POPULATION_SIZE, FitnessBuckets &buckets){
+    for (int fitness = 0; fitness <= MAX_EDGE_MISMATCH_COUNT; fitness++){
+        buckets.bucket[fitness].clear();
+    }
+    buckets.position.resize(POPULATION_SIZE);
+    buckets.worst = 0;
+    buckets.best = MAX_EDGE_MISMATCH_COUNT;
+    for (int i = 0; i < POPULATION_SIZE; i++){
+        insertIntoBuckets(buckets, i, population_arr.fitness[i]);
+    }
+}
+
+/**
+ * @brief Adds an individual to the bucket of its fitness.
+ *
+ * @param buckets The buckets.
+ * @param individual The individual, not in any bucket.
+ * @param fitness Its edge mismatch count.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::insertIntoBuckets(FitnessBuckets &buckets, int individual, int fitness){
+    buckets.position[individual] = buckets.bucket[fitness].size();
+    buckets.bucket[fitness].push_back(individual);
+    buckets.worst = max(buckets.worst, fitness);
+    buckets.best = min(buckets.best, fitness);
+}
+
+/**
+ * @brief Removes an individual from the bucket of its fitness.
+ *
+ * The bucket's last entry takes its place, so the removal is O(1).
+ *
+ * @param buckets The buckets.
+ * @param individual The individual.
+ * @param fitness The edge mismatch count it was inserted with.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::removeFromBuckets(FitnessBuckets &buckets, int individual, int fitness){
+    vector<int> &bucket = buckets.bucket[fitness];
+    int last = bucket.back();
+    bucket[buckets.position[individual]] = last;
+    buckets.position[last] = buckets.position[individual];
+    bucket.pop_back();
+}
+
+/**
+ * @brief Returns an individual with the highest edge mismatch count.
+ *
+ * The worst bound only moves down past empty buckets, so this is O(1) amortized.
+ * The buckets must not be empty.
+ *
+ * @param buckets The buckets.
+ * @return The individual.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::worstInBuckets(FitnessBuckets &buckets){
+    while (buckets.bucket[buckets.worst].empty()){
+        buckets.worst--;
+    }
+    return buckets.bucket[buckets.worst].back();
+}
+
+/**
+ * @brief Returns an individual with the lowest edge mismatch count.
+ *
+ * The buckets must not be empty.
+ *
+ * @param buckets The buckets.
+ * @return The individual.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::bestInBuckets(FitnessBuckets &buckets){
+    while (buckets.bucket[buckets.best].empty()){
+        buckets.best++;
+    }
+    return buckets.bucket[buckets.best].back();
+}
+
+/**
+ * @brief Picks an individual by tournament.
+ *
+ * @param population_arr The population, with every cached fitness up to date.
+ * @param POPULATION_SIZE The size of the population.
+ * @param rng The random stream the contestants are drawn from.
+ * @return The index of the contestant with the lowest edge mismatch count.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::tournamentSelect(const Population &population_arr, const int POPULATION_SIZE, Rng &rng){
+    int winner = randomBelow(rng, POPULATION_SIZE);
+    for (int k = 1; k < TOURNAMENT_SIZE; k++){
+        int contestant = randomBelow(rng, POPULATION_SIZE);
+        if (population_arr.fitness[contestant] < population_arr.fitness[winner]){
+            winner = contestant;
+        }
+    }
+    return winner;
+}
+
+/**
+ * @brief Evolves a population with a steady-state genetic algorithm.
+ *
+ * Every step picks two parents by tournament, builds two children on the stack and
+ * lets each one replace the current worst individual straight away unless it is
+ * worse. A generation is ratio_adjusted_pop_size children, as in evolve.
+ *
+ * @param population_arr The population of solutions.
+ * @param NUM_OF_GENERATIONS The number of generations to evolve the population.
+ * @param POPULATION_SIZE The size of the population.
+ * @param best_puzzle Receives the best puzzle found.
+ * @param local_search_method How each child is improved before it is inserted.
+ * @param completion_node_limit Node budget of the exact completion of the best individual, 0 to disable it.
+ * @return The lowest edge mismatch count found.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::evolveSteadyState(Population &population_arr, int NUM_OF_GENERATIONS, const int POPULATION_SIZE, const EdgeTable &edge_table, Rng &rng, bool print_flag, Puzzle best_puzzle, LocalSearchMethod local_search_method, long long completion_node_limit){
+    int min_edge_mismatch_count = INT_MAX;
+    int stagnated_generation_count = 0;
+    int stagnation_threshold = 1000;
+    stagnation_threshold = max(10, (stagnation_threshold/POPULATION_SIZE) * stagnation_threshold);
+    const int MAX_MUTATION_RATE = 32;
+    const int MAX_MISMATCH = MAX_EDGE_MISMATCH_COUNT;
+    int mutation_rate = MAX_MUTATION_RATE;
+    float ratio = 0.25;
+    int ratio_adjusted_pop_size = POPULATION_SIZE * ratio;
+    ratio_adjusted_pop_size = ratio_adjusted_pop_size % 2 == 0 ? ratio_adjusted_pop_size : ratio_adjusted_pop_size + 1;
+    int steps_per_generation = max(1, ratio_adjusted_pop_size / 2);
+
+    int mutation_rate_lut[MAX_MISMATCH];
+    float inverse_max_mismatch = 1.0f/MAX_MISMATCH;
+    for (int i = 0; i < MAX_MISMATCH; i++){
+        mutation_rate_lut[i] = max(3, (int)(i * inverse_max_mismatch * MAX_MUTATION_RATE));
+    }
+
+    refreshFitness(population_arr, POPULATION_SIZE, edge_table);
+    FitnessBuckets buckets;
+    buildFitnessBuckets(population_arr, POPULATION_SIZE, buckets);
+
+    Gene children[2][TILES_IN_PUZZLE_COUNT];
+    for (int generation = 1; generation <= NUM_OF_GENERATIONS; generation++){
+        for (int step = 0; step < steps_per_generation; step++){
+            copyPuzzle(population_arr[tournamentSelect(population_arr, POPULATION_SIZE, rng)], children[0]);
+            copyPuzzle(population_arr[tournamentSelect(population_arr, POPULATION_SIZE, rng)], children[1]);
+            if (min_edge_mismatch_count <= 10){
+                orderCrossover(children[0], children[1], rng);
+            }
+
+            for (int c = 0; c < 2; c++){
+                applyRandomMoves(children[c], randomBelow(rng, mutation_rate), rng);
+                repairRotations(children[c], edge_table);
+                int child_fitness = countEdgeMismatch(children[c], edge_table);
+                if (min_edge_mismatch_count <= LOCAL_SEARCH_THRESHOLD){
+                    child_fitness += hillClimb(children[c], edge_table, local_search_method, LOCAL_SEARCH_MOVE_BUDGET, LOCAL_SEARCH_TIME_BUDGET_US);
+                }
+
+                // the child is scored before it goes in, so the worst is never the child itself
+                int worst = worstInBuckets(buckets);
+                if (child_fitness > population_arr.fitness[worst]){
+                    continue;
+                }
+                removeFromBuckets(buckets, worst, population_arr.fitness[worst]);
+                copyPuzzle(children[c], population_arr[worst]);
+                population_arr.fitness[worst] = child_fitness;
+                insertIntoBuckets(buckets, worst, child_fitness);
+            }
+        }
+
+        int best = bestInBuckets(buckets);
+        int best_edge_mismatch = population_arr.fitness[best];
+        if (shouldCompleteExact(best_edge_mismatch, min_edge_mismatch_count, stagnated_generation_count, completion_node_limit)){
+            long long node_count;
+            if (completeExact(population_arr[best], edge_table, completion_node_limit, node_count)){
+                removeFromBuckets(buckets, best, best_edge_mismatch);
+                population_arr.fitness[best] = best_edge_mismatch = 0;
+                insertIntoBuckets(buckets, best, 0);
+            }
+        }
+        if (best_edge_mismatch < min_edge_mismatch_count){
+            min_edge_mismatch_count = best_edge_mismatch;
+            copyPuzzle(population_arr[best], best_puzzle);
+
+            if (print_flag){
+                printPuzzle(best_puzzle, edge_table);
+            }
+
+            if (best_edge_mismatch <= 25){
+                #pragma omp critical(save_puzzle)
+                savePuzzle(best_puzzle, edge_table, best_edge_mismatch);
+            }
+            stagnated_generation_count = 0;
+        }
+
+        if (print_flag){
+            cout << "GEN " << generation << " " << " edge mismatch: "  << best_edge_mismatch \
+            << " ... mutation rate: " << mutation_rate << " ... lowest edge mismatch: " << min_edge_mismatch_count << endl;
+        }
+
+        if (min_edge_mismatch_count == 0){
+            break;
+        }
+
+        // when fitness plateaus, will regenerate population with the best puzzle so far as the seed
+        if (++stagnated_generation_count == stagnation_threshold || stagnated_generation_count == stagnation_threshold * 10 || stagnated_generation_count == stagnation_threshold * 100){
+            generatePopulation(population_arr, best_puzzle, POPULATION_SIZE, rng);
+            refreshFitness(population_arr, POPULATION_SIZE, edge_table);
+            buildFitnessBuckets(population_arr, POPULATION_SIZE, buckets);
+            if (stagnated_generation_count == stagnation_threshold * 100){
+                stagnated_generation_count = 0;
+            }
+        }
+
+        mutation_rate = mutation_rate_lut[min(best_edge_mismatch, MAX_MISMATCH - 1)];
+    }
+    return min_edge_mismatch_count;
+}
+
+/**
+ * @brief Returns the default annealing settings: geometric cooling, no reheats, one replica.
+ *
+ * On the 8x8 input, reheating after 20000 stalled generations did not beat a single cooling.
+ */
+AnnealingSettings makeAnnealingSettings(){
+    AnnealingSettings settings;
+    settings.schedule = GEOMETRIC_COOLING;
+    settings.initial_temperature = ANNEALING_INITIAL_TEMPERATURE;
+    settings.final_temperature = ANNEALING_FINAL_TEMPERATURE;
+    settings.reheat_interval = 0;
+    settings.replica_count = 1;
+    return settings;
+}
+
+/**
+ * @brief Returns the temperature of a cooling schedule at some point of a run.
+ *
+ * Lundy-Mees cooling, T <- T / (1 + beta T), adds beta to 1 / T every step, so
+ * 1 / T moves linearly from 1 / start_temperature to 1 / end_temperature.
+ *
+ * @param schedule The cooling schedule.
+ * @param start_temperature The temperature at progress 0.
+ * @param end_temperature The temperature at progress 1.
+ * @param progress How far the run is, in [0, 1].
+ * @return The temperature.
+ */
+double coolingTemperature(CoolingSchedule schedule, double start_temperature, double end_temperature, double progress){
+    switch (schedule){
+        case LINEAR_COOLING:
+            return start_temperature + (end_temperature - start_temperature) * progress;
+        case LUNDY_MEES_COOLING:
+            return 1.0 / (1.0 / start_temperature + (1.0 / end_temperature - 1.0 / start_temperature) * progress);
+        default:
+            return start_temperature * pow(end_temperature / start_temperature, progress);
+    }
+}
+
+/**
+ * @brief The largest change in edge mismatch count of one annealing move: a swap of two tiles with four edges each.
+ */
+constexpr int MAX_ANNEALING_DELTA = 2 * TILE_SIZE;
+
+/**
+ * @brief One puzzle of an annealing run, at one temperature.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+struct EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::AnnealingReplica {
+    Puzzle puzzle;
+    int fitness;
+    Puzzle best_puzzle;  // the best puzzle held at this temperature
+    int best_fitness;
+    double temperature;
+    Rng rng;
+    uint64_t accept_below[MAX_ANNEALING_DELTA + 1]; // a move adding d mismatches is taken if the next random value is below accept_below[d]
+};
+
+/**
+ * @brief Returns the 64-bit random value below which an event of the given probability happens.
+ */
+static uint64_t probabilityThreshold(double probability){
+    // the largest double below 2^64, so the conversion cannot overflow
+    return (uint64_t)min(probability * 18446744073709551616.0, 18446744073709549568.0);
+}
+
+/**
+ * @brief Sets the temperature of a replica and its Metropolis acceptance thresholds.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::setReplicaTemperature(AnnealingReplica &replica, double temperature){
+    replica.temperature = temperature;
+    replica.accept_below[0] = UINT64_MAX;
+    for (int delta = 1; delta <= MAX_ANNEALING_DELTA; delta++){
+        replica.accept_below[delta] = probabilityThreshold(exp(-delta / temperature));
+    }
+}
+
+/**
+ * @brief Spreads the replicas over a geometric temperature ladder, coldest first.
+ *
+ * A single replica gets the coldest temperature.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::setLadderTemperatures(vector<AnnealingReplica> &replicas, double coldest_temperature, double hottest_temperature){
+    const int replica_count = replicas.size();
+    for (int r = 0; r < replica_count; r++){
+        double step = replica_count == 1 ? 0 : r / (replica_count - 1.0);
+        setReplicaTemperature(replicas[r], coldest_temperature * pow(hottest_temperature / coldest_temperature, step));
+    }
+}
+
+/**
+ * @brief Makes the given number of annealing moves on a replica.
+ *
+ * Half the moves swap two random tiles, scored by swapTileDelta; the others turn a
+ * random tile by one to three quarter turns, scored by countLocalEdgeMismatch around it.
+ * A move that does not add mismatches is always kept; one that adds d is kept with
+ * probability exp(-d / T), read from the replica's threshold table.
+ *
+ * @param replica The replica.
+ * @param move_count The number of moves; fewer once the replica reaches 0 mismatches.
+ * @param edge_table The edge table built from the input puzzle.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::annealReplica(AnnealingReplica &replica, int move_count, const EdgeTable &edge_table){
+    Puzzle puzzle = replica.puzzle;
+    Rng &rng = replica.rng;
+    for (int m = 0; m < move_count && replica.fitness > 0; m++){
+        uint64_t bits = nextRandom(rng);
+        int first_index = (int)(((bits >> 32) * (uint64_t)TILES_IN_PUZZLE_COUNT) >> 32);
+        int delta;
+        if (bits & 1){
+            int second_index = randomBelow(rng, TILES_IN_PUZZLE_COUNT - 1);
+            second_index += second_index >= first_index;
+            delta = swapTileDelta(puzzle, first_index, second_index, edge_table);
+            if (delta > 0 && nextRandom(rng) >= replica.accept_below[delta]){
+                swap(puzzle[first_index], puzzle[second_index]);
+                continue;
+            }
+        } else {
+            Gene gene = puzzle[first_index];
+            int turns = 1 + (int)((((bits >> 1) & 0xffffffffULL) * 3) >> 32);
+            int before = countLocalEdgeMismatch(puzzle, first_index, edge_table);
+            puzzle[first_index] = makeGene(getGeneTile(gene), (getGeneRotation(gene) + turns) & ROTATION_MASK);
+            delta = countLocalEdgeMismatch(puzzle, first_index, edge_table) - before;
+            if (delta > 0 && nextRandom(rng) >= replica.accept_below[delta]){
+                puzzle[first_index] = gene;
+                continue;
+            }
+        }
+
+        replica.fitness += delta;
+        if (replica.fitness < replica.best_fitness){
+            replica.best_fitness = replica.fitness;
+            copyPuzzle(puzzle, replica.best_puzzle);
+        }
+    }
+}
+
+/**
+ * @brief Solves the puzzle by simulated annealing, optionally with parallel tempering.
+ *
+ * Replica r holds temperature r of the ladder, coldest first. An exchange swaps the
+ * puzzles of two neighbouring temperatures and leaves the random streams in place,
+ * so each temperature keeps its own stream whichever thread runs it.
+ *
+ * @param puzzle The input puzzle, used by RANDOM_INITIALIZATION.
+ * @param NUM_OF_GENERATIONS The number of generations.
+ * @param POPULATION_SIZE The population size of the GA run to compare with.
+ * @param edge_table The edge table built from the input puzzle.
+ * @param rng The random stream of the run.
+ * @param print_flag Whether to print the progress of every generation.
+ * @param best_puzzle Receives the best puzzle found.
+ * @param settings The cooling schedule, temperatures, reheats and replica count.
+ * @param initialization_method How every replica's first puzzle is built: greedyConstruct,
+ *                              or random moves of the input puzzle.
+ * @return The lowest edge mismatch count found.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::anneal(const Gene* puzzle, int NUM_OF_GENERATIONS, const int POPULATION_SIZE, const EdgeTable &edge_table, Rng &rng, bool print_flag, Puzzle best_puzzle, const AnnealingSettings &settings, InitializationMethod initialization_method){
+    const int replica_count = max(1, settings.replica_count);
+    float ratio = 0.25;
+    int ratio_adjusted_pop_size = POPULATION_SIZE * ratio;
+    ratio_adjusted_pop_size = ratio_adjusted_pop_size % 2 == 0 ? ratio_adjusted_pop_size : ratio_adjusted_pop_size + 1;
+    const int moves_per_generation = max(1, ratio_adjusted_pop_size);
+
+    // every replica builds its first puzzle from its own stream, so no step depends on the thread count
+    const CandidateIndex candidate_index = buildCandidateIndex(edge_table);
+    vector<AnnealingReplica> replicas(replica_count);
+    uint64_t seed = nextRandom(rng);
+    int min_edge_mismatch_count = INT_MAX;
+    for (int r = 0; r < replica_count; r++){
+        AnnealingReplica &replica = replicas[r];
+        replica.rng = makeRng(seed, r);
+        replica.puzzle = allocatePuzzle();
+        if (initialization_method == GREEDY_INITIALIZATION){
+            greedyConstruct(replica.puzzle, candidate_index, edge_table, replica.rng);
+        } else {
+            copyPuzzle(puzzle, replica.puzzle);
+            applyRandomMoves(replica.puzzle, 2 * TILES_IN_PUZZLE_COUNT, replica.rng);
+        }
+        replica.fitness = countEdgeMismatch(replica.puzzle, edge_table);
+        replica.best_puzzle = allocatePuzzle();
+        replica.best_fitness = replica.fitness;
+        copyPuzzle(replica.puzzle, replica.best_puzzle);
+        if (replica.fitness < min_edge_mismatch_count){
+            min_edge_mismatch_count = replica.fitness;
+            copyPuzzle(replica.puzzle, best_puzzle);
+        }
+    }
+
+    // the coldest replica follows the schedule, the hottest stays at the initial temperature
+    const double hottest_temperature = settings.initial_temperature;
+    int phase_start = 0; // generation the current cooling phase started at, moved by reheats
+    double phase_temperature = settings.initial_temperature;
+    double temperature = phase_temperature;
+    setLadderTemperatures(replicas, temperature, hottest_temperature);
+
+    int stagnated_generation_count = 0;
+    int reheat_count = 0;
+    long long exchange_count = 0;
+    bool solved = min_edge_mismatch_count == 0;
+
+    #pragma omp parallel
+    {
+        for (int generation = 1; generation <= NUM_OF_GENERATIONS && !solved; generation++){
+            #pragma omp for schedule(static)
+            for (int r = 0; r < replica_count; r++){
+                annealReplica(replicas[r], moves_per_generation, edge_table);
+            }
+
+            #pragma omp single
+            {
+                int best = 0;
+                for (int r = 1; r < replica_count; r++){
+                    if (replicas[r].best_fitness < replicas[best].best_fitness){
+                        best = r;
+                    }
+                }
+                if (replicas[best].best_fitness < min_edge_mismatch_count){
+                    min_edge_mismatch_count = replicas[best].best_fitness;
+                    copyPuzzle(replicas[best].best_puzzle, best_puzzle);
+
+                    if (print_flag){
+                        printPuzzle(best_puzzle, edge_table);
+                    }
+
+                    if (min_edge_mismatch_count <= 25){
+                        #pragma omp critical(save_puzzle)
+                        savePuzzle(best_puzzle, edge_table, min_edge_mismatch_count);
+                    }
+                    stagnated_generation_count = 0;
+                }
+
+                if (print_flag){
+                    cout << "GEN " << generation << " " << " edge mismatch: "  << replicas[0].fitness \
+                    << " ... temperature: " << temperature << " ... lowest edge mismatch: " << min_edge_mismatch_count << endl;
+                }
+                solved = min_edge_mismatch_count == 0;
+
+                // stuck while cold: warm up again and cool over the generations that are left
+                if (++stagnated_generation_count >= settings.reheat_interval && settings.reheat_interval > 0
+                    && temperature < settings.initial_temperature * ANNEALING_REHEAT_FRACTION){
+                    phase_start = generation;
+                    phase_temperature = settings.initial_temperature * ANNEALING_REHEAT_FRACTION;
+                    stagnated_generation_count = 0;
+                    reheat_count++;
+                }
+
+                // neighbouring temperatures, alternating between even and odd pairs
+                for (int r = generation & 1; r + 1 < replica_count; r += 2){
+                    AnnealingReplica &colder = replicas[r];
+                    AnnealingReplica &hotter = replicas[r + 1];
+                    double exponent = (1.0 / colder.temperature - 1.0 / hotter.temperature) * (colder.fitness - hotter.fitness);
+                    if (exponent >= 0 || nextRandom(rng) < probabilityThreshold(exp(exponent))){
+                        swap(colder.puzzle, hotter.puzzle);
+                        swap(colder.fitness, hotter.fitness);
+                        exchange_count++;
+                    }
+                }
+
+                double progress = (double)(generation - phase_start) / max(1, NUM_OF_GENERATIONS - phase_start);
+                temperature = coolingTemperature(settings.schedule, phase_temperature, settings.final_temperature, progress);
+                setLadderTemperatures(replicas, temperature, hottest_temperature);
+            }
+        }
+    }
+
+    cout << "Annealing: " << replica_count << " replicas, " << reheat_count << " reheats, " << exchange_count << " replica exchanges" << endl;
+    // exchanges only permute the puzzles between replicas
+    for (int r = 0; r < replica_count; r++){
+        freePuzzle(replicas[r].puzzle);
+        freePuzzle(replicas[r].best_puzzle);
+    }
+    return min_edge_mismatch_count;
+}
+
+/**
+ * @brief Pushes a migrant onto a migration queue without blocking.
+ *
+ * Must only be called by the queue's sending island.
+ *
+ * @param queue The queue.
+ * @param puzzle The genome to send.
+ * @param fitness The genome's edge mismatch count.
+ * @return False if the queue was full and the migrant was dropped.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+bool EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::pushMigrant(MigrationQueue &queue, const Gene* puzzle, int fitness){
+    unsigned tail = queue.tail.load(memory_order_relaxed);
+    if (tail - queue.head.load(memory_order_acquire) == MIGRATION_QUEUE_CAPACITY){
+        return false;
+    }
+
+    Migrant &slot = queue.slots[tail % MIGRATION_QUEUE_CAPACITY];
+    copyPuzzle(puzzle, slot.genes);
+    slot.fitness = fitness;
+
+    // publishes the slot to the receiving island
+    queue.tail.store(tail + 1, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Pops a migrant from a migration queue without blocking.
+ *
+ * Must only be called by the queue's receiving island.
+ *
+ * @param queue The queue.
+ * @param puzzle Receives the genome.
+ * @param fitness Receives the genome's edge mismatch count.
+ * @return False if the queue was empty.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+bool EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::popMigrant(MigrationQueue &queue, Gene* puzzle, int &fitness){
+    unsigned head = queue.head.load(memory_order_relaxed);
+    if (head == queue.tail.load(memory_order_acquire)){
+        return false;
+    }
+
+    const Migrant &slot = queue.slots[head % MIGRATION_QUEUE_CAPACITY];
+    copyPuzzle(slot.genes, puzzle);
+    fitness = slot.fitness;
+
+    // hands the slot back to the sending island
+    queue.head.store(head + 1, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Checks whether an island can currently receive migrants.
+ *
+ * @param group The island group.
+ * @param index The island.
+ * @return True for thread islands, and for process islands that registered and have not exited.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+bool EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::isIslandRunning(const IslandGroup &group, int index){
+    return group.island_state == nullptr || group.island_state[index].load(memory_order_acquire) == ISLAND_RUNNING;
+}
+
+/**
+ * @brief Exchanges migrants between an island and its neighbours.
+ *
+ * Only islands that are running receive migrants; the ring skips over the others.
+ * The best individuals sit at the back of the ranking and the worst at the front,
+ * so emigrants are read from the back and immigrants overwrite from the front.
+ *
+ * @param population_arr The island's population.
+ * @param POPULATION_SIZE The size of the population.
+ * @param ratio_adjusted_pop_size The number of best and worst entries the ranking needs.
+ * @param sorted_index_by_fitness_vec The current ranking, updated in place.
+ * @param island The island.
+ * @param rng The island's random stream, used by the random topology.
+ * @return The number of migrants received.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::migrate(Population &population_arr, const int POPULATION_SIZE, const int ratio_adjusted_pop_size, vector<pair<int, int>> &sorted_index_by_fitness_vec, Island &island, Rng &rng){
+    IslandGroup &group = *island.group;
+    const int island_count = group.island_count;
+    const int migrant_count = min(group.migrant_count, POPULATION_SIZE / 2);
+    if (island_count < 2){
+        return 0;
+    }
+
+    // sending the best individuals
+    int destination_count = group.topology == FULLY_CONNECTED_TOPOLOGY ? island_count - 1 : 1;
+    for (int d = 0; d < destination_count; d++){
+        int destination;
+        if (group.topology == RING_TOPOLOGY){
+            destination = (island.index + 1) % island_count;
+            while (destination != island.index && !isIslandRunning(group, destination)){
+                destination = (destination + 1) % island_count;
+            }
+        } else if (group.topology == FULLY_CONNECTED_TOPOLOGY){
+            destination = (island.index + 1 + d) % island_count;
+        } else {
+            destination = (island.index + 1 + randomBelow(rng, island_count - 1)) % island_count;
+        }
+        if (destination == island.index || !isIslandRunning(group, destination)){
+            continue;
+        }
+
+        MigrationQueue &queue = group.queues[island.index * island_count + destination];
+        for (int m = 0; m < migrant_count; m++){
+            const pair<int, int> &emigrant = sorted_index_by_fitness_vec[POPULATION_SIZE - 1 - m];
+            if (!pushMigrant(queue, population_arr[emigrant.first], emigrant.second)){
+                break;
+            }
+        }
+    }
+
+    // receiving into the worst slots, without overwriting the individuals just sent
+    int received_count = 0;
+    for (int source = 0; source < island_count; source++){
+        if (source == island.index){
+            continue;
+        }
+        MigrationQueue &queue = group.queues[source * island_count + island.index];
+        while (received_count < POPULATION_SIZE - migrant_count){
+            int index = sorted_index_by_fitness_vec[received_count].first;
+            if (!popMigrant(queue, population_arr[index], population_arr.fitness[index])){
+                break;
+            }
+            population_arr.dirty[index] = false;
+            received_count++;
+        }
+    }
+
+    if (received_count > 0){
+        evaluateFitness(population_arr, POPULATION_SIZE, ratio_adjusted_pop_size, sorted_index_by_fitness_vec);
+    }
+    return received_count;
+}
+
+/**
+ * @brief Solves the puzzle with an island model: several populations evolving on their own threads.
+ *
+ * Islands get POPULATION_SIZE / island_count individuals each. Inner parallel loops
+ * of an island run on the island's thread only, since nested OpenMP parallelism is
+ * off by default.
+ *
+ * @param puzzle The input puzzle, seed of every island.
+ * @param island_count The number of islands.
+ * @param POPULATION_SIZE The total population size, split evenly across islands.
+ * @param NUM_OF_GENERATIONS The number of generations each island runs for.
+ * @param edge_table The edge table built from the input puzzle.
+ * @param rng The random stream the island streams are derived from.
+ * @param topology The migration topology.
+ * @param migration_interval The number of generations between two migrations.
+ * @param migrant_count The number of best individuals sent per destination per migration.
+ * @param print_flag Whether island 0 prints its progress.
+ * @param selection_method How every island picks its parents.
+ * @param local_search_method How every island improves its offspring (see evolve).
+ * @param initialization_method How every island generates its first population.
+ * @param completion_node_limit Node budget of every island's exact completion (see evolve).
+ * @param best_puzzle Receives the best puzzle of the best island, unless it is null.
+ * @return The lowest edge mismatch count found by any island.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::evolveIslands(const Gene* puzzle, int island_count, const int POPULATION_SIZE, int NUM_OF_GENERATIONS, const EdgeTable &edge_table, Rng &rng, MigrationTopology topology, int migration_interval, int migrant_count, bool print_flag, SelectionMethod selection_method, LocalSearchMethod local_search_method, InitializationMethod initialization_method, long long completion_node_limit, Puzzle best_puzzle){
+    const int island_population_size = max(2, POPULATION_SIZE / island_count);
+
+    IslandGroup group;
+    group.island_count = island_count;
+    group.topology = topology;
+    group.migration_interval = max(1, migration_interval);
+    group.migrant_count = max(1, migrant_count);
+    group.queues = new MigrationQueue[island_count * island_count];
+    for (int i = 0; i < island_count * island_count; i++){
+        group.queues[i].head.store(0);
+        group.queues[i].tail.store(0);
+    }
+    group.island_state = nullptr;
+    group.solved.store(false);
+
+    vector<Island> islands(island_count);
+    uint64_t seed = nextRandom(rng);
+    Gene input_puzzle[TILES_IN_PUZZLE_COUNT];
+    copyPuzzle(puzzle, input_puzzle);
+
+    #pragma omp parallel for num_threads(island_count) schedule(static, 1)
+    for (int i = 0; i < island_count; i++){
+        Island &island = islands[i];
+        island.group = &group;
+        island.index = i;
+        island.best_puzzle = allocatePuzzle();
+
+        Rng island_rng = makeRng(seed, i);
+        Population population_arr = allocatePopulation(island_population_size);
+        initializePopulation(population_arr, input_puzzle, island_population_size, edge_table, island_rng, initialization_method);
+        evolve(population_arr, NUM_OF_GENERATIONS, island_population_size, edge_table, island_rng, print_flag && i == 0, &island, selection_method, local_search_method, completion_node_limit);
+        freePopulation(population_arr);
+    }
+
+    int best_island = 0;
+    for (int i = 0; i < island_count; i++){
+        cout << "Island " << i << ": lowest edge mismatch " << islands[i].best_edge_mismatch << ", " << islands[i].restart_count << " restarts" << endl;
+        if (islands[i].best_edge_mismatch < islands[best_island].best_edge_mismatch){
+            best_island = i;
+        }
+    }
+    int min_edge_mismatch_count = islands[best_island].best_edge_mismatch;
+    cout << "\n\nBest Puzzle with " << min_edge_mismatch_count << " edge mismatches:\n";
+    printPuzzle(islands[best_island].best_puzzle, edge_table);
+    if (best_puzzle != nullptr){
+        copyPuzzle(islands[best_island].best_puzzle, best_puzzle);
+    }
+
+    for (int i = 0; i < island_count; i++){
+        freePuzzle(islands[i].best_puzzle);
+    }
+    delete[] group.queues;
+    return min_edge_mismatch_count;
+}
+
+/**
+ * @brief Rounds a byte offset up to a multiple of the cache line size.
+ *
+ * @param offset The offset.
+ * @return The aligned offset.
+ */
+static size_t alignToCacheLine(size_t offset){
+    return (offset + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+}
+
+/**
+ * @brief Solves the puzzle with an island model where every island is a separate process.
+ *
+ * The segment is laid out as [IslandGroup][island states][ProcessSlots][MigrationQueues],
+ * each part starting on a cache line. It is mapped before forking, so every island sees
+ * it at the same address and the group's pointers stay valid in all processes.
+ *
+ * @param puzzle The input puzzle, seed of every island.
+ * @param process_count The number of island processes.
+ * @param POPULATION_SIZE The total population size, split evenly across islands.
+ * @param NUM_OF_GENERATIONS The number of generations each island runs for.
+ * @param edge_table The edge table built from the input puzzle.
+ * @param rng The random stream the island streams are derived from.
+ * @param topology The migration topology.
+ * @param migration_interval The number of generations between two migrations.
+ * @param migrant_count The number of best individuals sent per destination per migration.
+ * @param print_flag Whether island 0 prints its progress.
+ * @param selection_method How every island picks its parents.
+ * @param local_search_method How every island improves its offspring (see evolve).
+ * @param initialization_method How every island generates its first population.
+ * @param completion_node_limit Node budget of every island's exact completion (see evolve).
+ * @param best_puzzle Receives the best puzzle of the best island, unless it is null.
+ * @return The lowest edge mismatch count found by any island that finished, or -1 if none did.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::evolveProcesses(const Gene* puzzle, int process_count, const int POPULATION_SIZE, int NUM_OF_GENERATIONS, const EdgeTable &edge_table, Rng &rng, MigrationTopology topology, int migration_interval, int migrant_count, bool print_flag, SelectionMethod selection_method, LocalSearchMethod local_search_method, InitializationMethod initialization_method, long long completion_node_limit, Puzzle best_puzzle){
+#ifdef _WIN32
+    cout << "Multi-process islands need POSIX shared memory, running the islands as threads" << endl;
+    return evolveIslands(puzzle, process_count, POPULATION_SIZE, NUM_OF_GENERATIONS, edge_table, rng, topology, migration_interval, migrant_count, print_flag, selection_method, local_search_method, initialization_method, completion_node_limit, best_puzzle);
+#else
+    const int island_population_size = max(2, POPULATION_SIZE / process_count);
+
+    const size_t state_offset = alignToCacheLine(sizeof(IslandGroup));
+    const size_t slot_offset = alignToCacheLine(state_offset + process_count * sizeof(atomic<int>));
+    const size_t queue_offset = alignToCacheLine(slot_offset + process_count * sizeof(ProcessSlot));
+    const size_t segment_size = queue_offset + (size_t)process_count * process_count * sizeof(MigrationQueue);
+
+    ostringstream segment_name;
+    segment_name << "/evol-puzzle-" << getpid();
+    int fd = shm_open(segment_name.str().c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd < 0){
+        cerr << "Unable to create shared memory segment " << segment_name.str() << endl;
+        return -1;
+    }
+    if (ftruncate(fd, segment_size) != 0){
+        cerr << "Unable to size shared memory segment " << segment_name.str() << endl;
+        close(fd);
+        shm_unlink(segment_name.str().c_str());
+        return -1;
+    }
+    char* segment = (char*)mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    // the mapping keeps the segment alive; unlinking now means a crash cannot leak it
+    shm_unlink(segment_name.str().c_str());
+    if (segment == MAP_FAILED){
+        cerr << "Unable to map shared memory segment " << segment_name.str() << endl;
+        return -1;
+    }
+
+    IslandGroup* group = new (segment) IslandGroup;
+    atomic<int>* island_state = reinterpret_cast<atomic<int>*>(segment + state_offset);
+    ProcessSlot* slots = reinterpret_cast<ProcessSlot*>(segment + slot_offset);
+    MigrationQueue* queues = reinterpret_cast<MigrationQueue*>(segment + queue_offset);
+
+    group->island_count = process_count;
+    group->topology = topology;
+    group->migration_interval = max(1, migration_interval);
+    group->migrant_count = max(1, migrant_count);
+    group->queues = queues;
+    group->island_state = island_state;
+    group->solved.store(false);
+    for (int i = 0; i < process_count; i++){
+        new (&island_state[i]) atomic<int>(ISLAND_STARTING);
+        new (&slots[i]) ProcessSlot;
+        slots[i].pid.store(0);
+        slots[i].best.fitness = INT_MAX;
+        slots[i].restart_count = 0;
+    }
+    for (int i = 0; i < process_count * process_count; i++){
+        new (&queues[i]) MigrationQueue;
+        queues[i].head.store(0);
+        queues[i].tail.store(0);
+    }
+
+    uint64_t seed = nextRandom(rng);
+    Gene input_puzzle[TILES_IN_PUZZLE_COUNT];
+    copyPuzzle(puzzle, input_puzzle);
+    cout.flush();
+
+    vector<pid_t> pids(process_count, -1);
+    for (int i = 0; i < process_count; i++){
+        pid_t pid = fork();
+        if (pid < 0){
+            cerr << "Unable to start island " << i << endl;
+            island_state[i].store(ISLAND_CRASHED, memory_order_release);
+            continue;
+        }
+        if (pid == 0){
+#ifdef _OPENMP
+            omp_set_num_threads(max(1, omp_get_num_procs() / process_count));
+#endif
+            // registering makes this island visible to its peers
+            slots[i].pid.store(getpid(), memory_order_relaxed);
+            island_state[i].store(ISLAND_RUNNING, memory_order_release);
+
+            Island island;
+            island.group = group;
+            island.index = i;
+            island.best_puzzle = slots[i].best.genes;
+
+            Rng island_rng = makeRng(seed, i);
+            Population population_arr = allocatePopulation(island_population_size);
+            initializePopulation(population_arr, input_puzzle, island_population_size, edge_table, island_rng, initialization_method);
+            evolve(population_arr, NUM_OF_GENERATIONS, island_population_size, edge_table, island_rng, print_flag && i == 0, &island, selection_method, local_search_method, completion_node_limit);
+            freePopulation(population_arr);
+
+            slots[i].best.fitness = island.best_edge_mismatch;
+            slots[i].restart_count = island.restart_count;
+            island_state[i].store(ISLAND_FINISHED, memory_order_release);
+            cout.flush();
+            _exit(0);
+        }
+        pids[i] = pid;
+    }
+
+    // reaping every island; one that did not exit normally is marked crashed so peers stop sending to it
+    for (int reaped = 0; reaped < process_count; reaped++){
+        int status;
+        pid_t pid = wait(&status);
+        if (pid < 0){
+            break;
+        }
+        int i = find(pids.begin(), pids.end(), pid) - pids.begin();
+        if (i == process_count){
+            reaped--;
+            continue;
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || island_state[i].load(memory_order_acquire) != ISLAND_FINISHED){
+            island_state[i].store(ISLAND_CRASHED, memory_order_release);
+            cerr << "Island " << i << " (pid " << pid << ") exited abnormally" << endl;
+        }
+    }
+
+    int best_island = -1;
+    for (int i = 0; i < process_count; i++){
+        if (island_state[i].load(memory_order_acquire) != ISLAND_FINISHED){
+            cout << "Island " << i << ": crashed" << endl;
+            continue;
+        }
+        cout << "Island " << i << ": lowest edge mismatch " << slots[i].best.fitness << ", " << slots[i].restart_count << " restarts" << endl;
+        if (best_island < 0 || slots[i].best.fitness < slots[best_island].best.fitness){
+            best_island = i;
+        }
+    }
+
+    int min_edge_mismatch_count = -1;
+    if (best_island >= 0){
+        min_edge_mismatch_count = slots[best_island].best.fitness;
+        cout << "\n\nBest Puzzle with " << min_edge_mismatch_count << " edge mismatches:\n";
+        printPuzzle(slots[best_island].best.genes, edge_table);
+        if (best_puzzle != nullptr){
+            copyPuzzle(slots[best_island].best.genes, best_puzzle);
+        }
+    }
+
+    munmap(segment, segment_size);
+    return min_edge_mismatch_count;
+#endif
+}
+
+/**
+ * @brief Arguments shared by the mutateIndividual tasks of one mutate call.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+struct EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::MutationContext {
+    Population* offspring_arr;
+    const int* individual_index; // slot mutated by each task, or null for slot == task
+    const EdgeTable* edge_table;
+    int mutation_rate;
+    uint64_t seed;
+};
+
+/**
+ * @brief Applies a random number of swaps and rotations to one individual.
+ *
+ * @param task_index The task, which selects the individual and its stream.
+ * @param context The MutationContext of the call.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::mutateIndividual(int task_index, void* context){
+    const MutationContext &args = *static_cast<MutationContext*>(context);
+    Population &offspring_arr = *args.offspring_arr;
+    const EdgeTable &edge_table = *args.edge_table;
+    const int mutation_rate = args.mutation_rate;
+    const int i = args.individual_index != nullptr ? args.individual_index[task_index] : task_index;
+
+    Rng individual_rng = makeRng(args.seed, task_index);
+    // if (randomTileIndex(individual_rng) % 8 <= 2){
+    //     return;
+    // }
+    //int num_iterations = randomTileIndex(individual_rng) % 32;
+    int num_iterations = randomBelow(individual_rng, mutation_rate);
+
+    // past a few moves the deltas cost more than one batched rescore, so leave it to refreshFitness
+    if (num_iterations > MAX_DELTA_TRACKED_MOVES){
+        offspring_arr.dirty[i] = true;
+        applyRandomMoves(offspring_arr[i], num_iterations, individual_rng);
+        repairRotations(offspring_arr[i], edge_table);
+        return;
+    }
+
+    for (int j = 0; j < num_iterations; j++){
+        if(j % 2 == 0) {
+            int first_index = randomTileIndex(individual_rng);
+            int second_index = first_index;
+            while (second_index == first_index){
+                second_index = randomTileIndex(individual_rng);
+            }
+            offspring_arr.fitness[i] += swapTileDelta(offspring_arr[i], first_index, second_index, edge_table);
+        } else {
+            offspring_arr.fitness[i] += bestRotationDelta(offspring_arr[i], randomTileIndex(individual_rng), edge_table);
+        }
+
+    }
+    offspring_arr.fitness[i] += repairRotations(offspring_arr[i], edge_table);
+}
+
+/**
+ * @brief Mutates a population of puzzles by performing random rotations and swaps.
+ * 
+ * This function iterates over each puzzle in the population and performs a series of 
+ * random rotations and swaps on the tiles within each puzzle. The number of rotations 
+ * and swaps is determined randomly for each puzzle.
+ * 
+ * @param offspring_arr The population of puzzles to mutate.
+ * @param POPULATION_SIZE The number of puzzles in the population.
+ * 
+ * The function draws from the caller's random stream. For each puzzle, it generates
+ * a random number of iterations and performs 
+ * the following operations:
+ * - Turns a randomly selected tile to its best rotation for its neighbours
+ *   (bestRotationDelta), or rotates it by one (rotateGene) once the puzzle is dirty.
+ * - Swaps tiles within the puzzle.
+ * Every puzzle then gets repairRotations, so no tile is left in a rotation that
+ * mismatches more edges than another one would.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::mutate(Population &offspring_arr, const int POPULATION_SIZE, const EdgeTable &edge_table, Rng &rng, int mutation_rate){
+    MutationContext context;
+    context.offspring_arr = &offspring_arr;
+    context.individual_index = nullptr;
+    context.edge_table = &edge_table;
+    context.mutation_rate = mutation_rate;
+    // every individual gets its own stream, so the result does not depend on the thread count or scheduling
+    context.seed = nextRandom(rng);
+
+    // the number of moves varies per individual, so individuals are work-stolen tasks
+    runWorkStealing(POPULATION_SIZE, mutateIndividual, &context);
+}
+
+/**
+ * @brief Mutates the given individuals of a population.
+ *
+ * Same as mutate over a whole population, with task k mutating individual
+ * individual_index_vec[k] from stream k, so the offspring crossover built in their
+ * replacement slots are mutated there.
+ *
+ * @param population_arr The population.
+ * @param individual_index_vec The individuals to mutate, without duplicates.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::mutate(Population &population_arr, const vector<int> &individual_index_vec, const EdgeTable &edge_table, Rng &rng, int mutation_rate){
+    MutationContext context;
+    context.offspring_arr = &population_arr;
+    context.individual_index = individual_index_vec.data();
+    context.edge_table = &edge_table;
+    context.mutation_rate = mutation_rate;
+    context.seed = nextRandom(rng);
+
+    runWorkStealing(individual_index_vec.size(), mutateIndividual, &context);
+}
+
+/**
+ * @brief Improves a puzzle by hill climbing over tile swaps and rotations.
+ *
+ * Every move is scored in O(1) with swapTileDelta or rotateGeneDelta and undone if it
+ * is not kept. A move can only remove mismatches on the edges around its positions,
+ * so only moves whose first position has a mismatching edge are tried. First
+ * improvement keeps every improving move as soon as it is found; best improvement
+ * scores a whole pass and keeps its best move. The search stops at a local optimum
+ * or once either budget is spent.
+ *
+ * @param puzzle The puzzle, improved in place.
+ * @param edge_table The edge table built from the input puzzle.
+ * @param method FIRST_IMPROVEMENT_LOCAL_SEARCH or BEST_IMPROVEMENT_LOCAL_SEARCH; NO_LOCAL_SEARCH does nothing.
+ * @param move_budget The most moves scored.
+ * @param time_budget_us The most time spent, in microseconds, checked once per position.
+ * @return The change in edge mismatch count, never positive.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::hillClimb(Puzzle puzzle, const EdgeTable &edge_table, LocalSearchMethod method, int move_budget, int time_budget_us){
+    if (method == NO_LOCAL_SEARCH){
+        return 0;
+    }
+    const bool first_improvement = method == FIRST_IMPROVEMENT_LOCAL_SEARCH;
+    const chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::microseconds(time_budget_us);
+
+    int total_delta = 0;
+    int move_count = 0;
+    bool improved = true;
+    while (improved && move_count < move_budget){
+        improved = false;
+        // best move of the pass: a swap with second_index, or rotation_count rotations when second_index < 0
+        int best_delta = 0;
+        int best_first_index = -1;
+        int best_second_index = -1;
+        int best_rotation_count = 0;
+
+        for (int first_index = 0; first_index < TILES_IN_PUZZLE_COUNT && move_count < move_budget; first_index++){
+            if (countLocalEdgeMismatch(puzzle, first_index, edge_table) == 0){
+                continue;
+            }
+            if (chrono::steady_clock::now() >= deadline){
+                move_count = move_budget;
+                break;
+            }
+
+            // the three other rotations, then a fourth one back to the original
+            int rotation_delta = 0;
+            int rotation_count = 0;
+            for (int r = 1; r < TILE_SIZE; r++){
+                rotation_delta += rotateGeneDelta(puzzle, first_index, edge_table);
+                move_count++;
+                if (rotation_delta < best_delta){
+                    best_delta = rotation_delta;
+                    best_first_index = first_index;
+                    best_second_index = -1;
+                    best_rotation_count = r;
+                }
+                if (first_improvement && rotation_delta < 0){
+                    rotation_count = r;
+                    break;
+                }
+            }
+            if (first_improvement && rotation_count > 0){
+                total_delta += rotation_delta;
+                best_delta = 0;
+                improved = true;
+            } else {
+                rotateGene(puzzle[first_index]);
+            }
+
+            for (int second_index = 0; second_index < TILES_IN_PUZZLE_COUNT && move_count < move_budget; second_index++){
+                if (second_index == first_index){
+                    continue;
+                }
+                int swap_delta = swapTileDelta(puzzle, first_index, second_index, edge_table);
+                move_count++;
+                if (first_improvement && swap_delta < 0){
+                    total_delta += swap_delta;
+                    improved = true;
+                    continue;
+                }
+                if (swap_delta < best_delta){
+                    best_delta = swap_delta;
+                    best_first_index = first_index;
+                    best_second_index = second_index;
+                }
+                swap(puzzle[first_index], puzzle[second_index]);
+            }
+        }
+
+        if (!first_improvement && best_delta < 0){
+            if (best_second_index < 0){
+                for (int r = 0; r < best_rotation_count; r++){
+                    rotateGene(puzzle[best_first_index]);
+                }
+            } else {
+                swap(puzzle[best_first_index], puzzle[best_second_index]);
+            }
+            total_delta += best_delta;
+            improved = true;
+        }
+    }
+    return total_delta;
+}
+
+/**
+ * @brief Arguments shared by the improveIndividual tasks of one localSearch call.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+struct EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::LocalSearchContext {
+    Population* population_arr;
+    const int* individual_index;
+    const EdgeTable* edge_table;
+    LocalSearchMethod method;
+};
+
+/**
+ * @brief Runs hillClimb on one individual and updates its cached fitness.
+ *
+ * @param task_index The task, which selects the individual.
+ * @param context The LocalSearchContext of the call.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::improveIndividual(int task_index, void* context){
+    const LocalSearchContext &args = *static_cast<LocalSearchContext*>(context);
+    Population &population_arr = *args.population_arr;
+    const int i = args.individual_index[task_index];
+
+    int delta = hillClimb(population_arr[i], *args.edge_table, args.method, LOCAL_SEARCH_MOVE_BUDGET, LOCAL_SEARCH_TIME_BUDGET_US);
+    // a dirty individual is rescored by refreshFitness, moves included
+    if (!population_arr.dirty[i]){
+        population_arr.fitness[i] += delta;
+    }
+}
+
+/**
+ * @brief Improves the given individuals of a population with hillClimb.
+ *
+ * Each individual is one runWorkStealing task with LOCAL_SEARCH_MOVE_BUDGET moves and
+ * LOCAL_SEARCH_TIME_BUDGET_US microseconds. The search uses no randomness, so only
+ * the time budget can make the result depend on the machine.
+ *
+ * @param population_arr The population.
+ * @param individual_index_vec The individuals to improve, without duplicates.
+ * @param edge_table The edge table built from the input puzzle.
+ * @param method The hill-climbing strategy; NO_LOCAL_SEARCH does nothing.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::localSearch(Population &population_arr, const vector<int> &individual_index_vec, const EdgeTable &edge_table, LocalSearchMethod method){
+    if (method == NO_LOCAL_SEARCH){
+        return;
+    }
+    LocalSearchContext context;
+    context.population_arr = &population_arr;
+    context.individual_index = individual_index_vec.data();
+    context.edge_table = &edge_table;
+    context.method = method;
+
+    runWorkStealing(individual_index_vec.size(), improveIndividual, &context);
+}
+
+
+/**
+ * @brief Every tile class of the input in every distinct rotation, grouped by the motifs it shows above and on the left.
+ *
+ * Entries are `c << 2 | r`, class c turned by r left rotations from its representative.
+ * Group `(top + 1) * (MOTIF_COUNT + 1) + left + 1` lists the entries with that top and
+ * left motif, where -1 stands for "any": every entry is listed in the exact group and
+ * in the three groups that leave one or both sides open, so a position on the border
+ * or next to an empty position finds its candidates with a single lookup. Rotations
+ * that repeat a class's tile are listed once, and so are classes with several input
+ * tiles, so the search never tries two placements that lead to the same puzzle.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+struct EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::ExactIndex {
+    int start[(MOTIF_COUNT + 1) * (MOTIF_COUNT + 1) + 1];
+    int entries[TILES_IN_PUZZLE_COUNT * TILE_SIZE * 4];
+    int representative[TILES_IN_PUZZLE_COUNT];  // first input tile of each class
+    int tile_class[TILES_IN_PUZZLE_COUNT];      // class of each input tile
+    int rotation_offset[TILES_IN_PUZZLE_COUNT]; // rotation of each input tile that equals its representative unrotated
+    int class_start[TILES_IN_PUZZLE_COUNT + 1]; // input tiles of class c are class_tiles[class_start[c]..class_start[c + 1])
+    int class_tiles[TILES_IN_PUZZLE_COUNT];
+    int class_count;
+};
+
+/**
+ * @brief Number of nodes an exact search counts locally before adding them to the shared count.
+ */
+constexpr int EXACT_NODE_BATCH = 4096;
+
+/**
+ * @brief Builds the exact solver's index from the edge table.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::buildExactIndex(const EdgeTable &edge_table, ExactIndex &index){
+    // like buildTileClassTable, but comparing with the class representatives keeps the index off the heap
+    index.class_count = 0;
+    for (int t = 0; t < TILES_IN_PUZZLE_COUNT; t++){
+        int c = 0;
+        int r = 0;
+        for (; c < index.class_count; c++){
+            r = 0;
+            while (r < TILE_SIZE && edge_table.tiles[t][r] != edge_table.tiles[index.representative[c]][0]){
+                r++;
+            }
+            if (r < TILE_SIZE){
+                break;
+            }
+        }
+        if (c == index.class_count){
+            index.representative[index.class_count++] = t;
+            r = 0;
+        }
+        index.tile_class[t] = c;
+        index.rotation_offset[t] = r;
+    }
+
+    // input tiles by class, in increasing order
+    memset(index.class_start, 0, sizeof(index.class_start));
+    for (int t = 0; t < TILES_IN_PUZZLE_COUNT; t++){
+        index.class_start[index.tile_class[t] + 1]++;
+    }
+    for (int c = 0; c < index.class_count; c++){
+        index.class_start[c + 1] += index.class_start[c];
+    }
+    int class_fill[TILES_IN_PUZZLE_COUNT];
+    copy(index.class_start, index.class_start + index.class_count, class_fill);
+    for (int t = 0; t < TILES_IN_PUZZLE_COUNT; t++){
+        index.class_tiles[class_fill[index.tile_class[t]]++] = t;
+    }
+
+    // counting sort of the entries into their four groups each
+    const int group_count = (MOTIF_COUNT + 1) * (MOTIF_COUNT + 1);
+    int group_size[group_count + 1];
+    memset(group_size, 0, sizeof(group_size));
+    for (int pass = 0; pass < 2; pass++){
+        for (int c = 0; c < index.class_count; c++){
+            const int representative = index.representative[c];
+            for (int r = 0; r < TILE_SIZE; r++){
+                // a symmetric tile repeats itself after two or one rotations
+                bool repeated = false;
+                for (int s = 0; s < r; s++){
+                    repeated |= edge_table.tiles[representative][s] == edge_table.tiles[representative][r];
+                }
+                if (repeated){
+                    continue;
+                }
+                const int top = edge_table.edges[representative][r][TOP];
+                const int left = edge_table.edges[representative][r][LEFT];
+                const int groups[4] = {
+                    (top + 1) * (MOTIF_COUNT + 1) + left + 1,
+                    (top + 1) * (MOTIF_COUNT + 1),
+                    left + 1,
+                    0
+                };
+                for (int g = 0; g < 4; g++){
+                    if (pass == 0){
+                        group_size[groups[g]]++;
+                    } else {
+                        index.entries[group_size[groups[g]]++] = c << ROTATION_BITS | r;
+                    }
+                }
+            }
+        }
+        if (pass == 0){
+            index.start[0] = 0;
+            for (int group = 0; group < group_count; group++){
+                index.start[group + 1] = index.start[group] + group_size[group];
+                group_size[group] = index.start[group];
+            }
+        }
+    }
+}
+
+/**
+ * @brief The state of one depth-first exact search.
+ *
+ * The search fills the free positions in increasing order, so in a full solve the
+ * only placed neighbours of a position are above and on the left. Positions that
+ * are not free hold fixed tiles that every placement must match as well.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+struct EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::ExactSearch {
+    const EdgeTable* edge_table;
+    const ExactIndex* index;
+    Gene puzzle[TILES_IN_PUZZLE_COUNT];
+    bool placed[TILES_IN_PUZZLE_COUNT];
+    int free_position[TILES_IN_PUZZLE_COUNT];
+    int free_count;
+    int remaining[TILES_IN_PUZZLE_COUNT];      // unplaced input tiles of each class
+    uint64_t available[EXACT_CLASS_WORDS];     // bit c is set while class c has unplaced tiles
+    int path[TILES_IN_PUZZLE_COUNT];           // entry placed at each depth
+    int class_tiles[TILES_IN_PUZZLE_COUNT];    // unplaced tiles of class c are class_tiles[class_start[c]..+remaining[c])
+    long long local_node_count;                // nodes not yet added to node_count
+    long long node_limit;
+    atomic<long long>* node_count;
+    atomic<bool>* stop;                        // set by the search that runs out of nodes
+    const atomic<int>* solved_task;            // lowest task with a solution, nullptr outside tasks
+    int task_index;
+    bool aborted;
+    int collect_depth;                         // when >= 0, paths of this length are collected instead of searched
+    vector<int>* collected_paths;
+};
+
+/**
+ * @brief Starts an exact search in which every position is free and every tile unplaced.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::initExactSearch(ExactSearch &search, const EdgeTable &edge_table, const ExactIndex &index){
+    search.edge_table = &edge_table;
+    search.index = &index;
+    memset(search.placed, 0, sizeof(search.placed));
+    search.free_count = TILES_IN_PUZZLE_COUNT;
+    memset(search.available, 0, sizeof(search.available));
+    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+        search.free_position[i] = i;
+    }
+    for (int c = 0; c < index.class_count; c++){
+        search.remaining[c] = index.class_start[c + 1] - index.class_start[c];
+        search.available[c >> 6] |= 1ULL << (c & 63);
+    }
+    copy(index.class_tiles, index.class_tiles + TILES_IN_PUZZLE_COUNT, search.class_tiles);
+    search.local_node_count = 0;
+    search.solved_task = nullptr;
+    search.task_index = 0;
+    search.aborted = false;
+    search.collect_depth = -1;
+    search.collected_paths = nullptr;
+}
+
+/**
+ * @brief Restricts an exact search to the free positions of a puzzle.
+ *
+ * The tiles on the other positions stay where they are, and every placement must
+ * match them on all four sides. Only the tiles on the free positions are placed.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::restrictExactSearch(ExactSearch &search, const Gene* puzzle, const bool* free){
+    const ExactIndex &index = *search.index;
+    copyPuzzle(puzzle, search.puzzle);
+    memset(search.available, 0, sizeof(search.available));
+    fill(search.remaining, search.remaining + index.class_count, 0);
+    search.free_count = 0;
+    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+        search.placed[i] = !free[i];
+        if (free[i]){
+            search.free_position[search.free_count++] = i;
+            const int t = getGeneTile(puzzle[i]);
+            const int c = index.tile_class[t];
+            search.class_tiles[index.class_start[c] + search.remaining[c]++] = t;
+            search.available[c >> 6] |= 1ULL << (c & 63);
         }
     }
+}
 
-    return make_pair(crossover_point1, crossover_point2);
+/**
+ * @brief Places an index entry on the free position of the given depth.
+ *
+ * The tile is the last unplaced input tile of the entry's class, turned so that it
+ * looks like the class representative in the entry's rotation.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::placeExactEntry(ExactSearch &search, int depth, int entry){
+    const ExactIndex &index = *search.index;
+    const int c = entry >> ROTATION_BITS;
+    const int t = search.class_tiles[index.class_start[c] + --search.remaining[c]];
+    if (search.remaining[c] == 0){
+        search.available[c >> 6] &= ~(1ULL << (c & 63));
+    }
+    const int position = search.free_position[depth];
+    search.puzzle[position] = makeGene(t, (index.rotation_offset[t] + (entry & ROTATION_MASK)) & ROTATION_MASK);
+    search.placed[position] = true;
+    search.path[depth] = entry;
 }
 
-void orderCrossover(int** offspring1, int** offspring2, const unordered_map<string, int> &duplicatesMap, const unordered_map<string, string> &map_of_tiles, pair<mt19937, uniform_int_distribution<int>> random){
+/**
+ * @brief Undoes placeExactEntry.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::removeExactEntry(ExactSearch &search, int depth, int entry){
+    const int c = entry >> ROTATION_BITS;
+    search.remaining[c]++;
+    search.available[c >> 6] |= 1ULL << (c & 63);
+    search.placed[search.free_position[depth]] = false;
+}
 
-    int** parent1 = allocatePuzzle();
-    int** parent2 = allocatePuzzle();
-    copyPuzzle(offspring1, parent1);
-    copyPuzzle(offspring2, parent2);
+/**
+ * @brief Returns the motif a placed neighbour shows towards a position, or -1 if there is none.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+inline int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::facingMotif(const ExactSearch &search, int neighbour, int edge){
+    return search.placed[neighbour] ? getGeneEdge(*search.edge_table, search.puzzle[neighbour], edge) : -1;
+}
 
-    unordered_map<string, int> trackedDuplicates1 = duplicatesMap;
-    for (auto it = trackedDuplicates1.begin(); it != trackedDuplicates1.end(); it++){
-        it->second = 0;
+/**
+ * @brief Fills the free positions from the given depth on, backtracking on every mismatch.
+ *
+ * @return true once every free position is filled without a mismatch.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+bool EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::searchExact(ExactSearch &search, int depth){
+    if (depth == search.free_count){
+        return true;
     }
-    unordered_map<string, int> trackedDuplicates2 = trackedDuplicates1;
-
-    // Generate the crossover points
-    int crossover_point1 = random.second(random.first);
-    int crossover_point2 = random.second(random.first);
-
-    // Ensure CrossoverPoint1 < CrossoverPoint2
-    if (crossover_point1 > crossover_point2){
-        int temp = crossover_point1;
-        crossover_point1 = crossover_point2;
-        crossover_point2 = temp;
+    if (depth == search.collect_depth){
+        search.collected_paths->insert(search.collected_paths->end(), search.path, search.path + depth);
+        return false;
     }
-    
-    // Perform two-point crossover
-    for (int i = crossover_point1; i < crossover_point2; i++){
-        copyTile(parent1[i], offspring2[i]);
-        copyTile(parent2[i], offspring1[i]);
+    if (++search.local_node_count == EXACT_NODE_BATCH){
+        long long node_count = search.node_count->fetch_add(search.local_node_count, memory_order_relaxed) + search.local_node_count;
+        search.local_node_count = 0;
+        if (node_count >= search.node_limit){
+            search.stop->store(true, memory_order_relaxed);
+        }
+        if (search.stop->load(memory_order_relaxed) || (search.solved_task != nullptr && search.solved_task->load(memory_order_relaxed) < search.task_index)){
+            search.aborted = true;
+            return false;
+        }
     }
 
-    // updating trackedDuplicates maps based on what's in between crossover points.
-    for (int i = crossover_point1; i < crossover_point2; i++){
-        string parent1_tile = convertTileToString(parent1[i]);
-        string parent2_tile = convertTileToString(parent2[i]);
-
-        pair<bool, string> tile1_found = isTileInMap(map_of_tiles, parent1_tile);
-        if (tile1_found.first){
-            trackedDuplicates1[tile1_found.second]++;
+    const int position = search.free_position[depth];
+    const int row = position / PUZZLE_WIDTH;
+    const int column = position % PUZZLE_WIDTH;
+    const int top = row > 0 ? facingMotif(search, position - PUZZLE_WIDTH, BOTTOM) : -1;
+    const int left = column > 0 ? facingMotif(search, position - 1, RIGHT) : -1;
+    const int right = column < PUZZLE_WIDTH - 1 ? facingMotif(search, position + 1, LEFT) : -1;
+    const int bottom = row < PUZZLE_HEIGHT - 1 ? facingMotif(search, position + PUZZLE_WIDTH, TOP) : -1;
+
+    const ExactIndex &index = *search.index;
+    const int group = (top + 1) * (MOTIF_COUNT + 1) + left + 1;
+    for (int k = index.start[group]; k < index.start[group + 1]; k++){
+        const int entry = index.entries[k];
+        const int c = entry >> ROTATION_BITS;
+        if (!(search.available[c >> 6] >> (c & 63) & 1)){
+            continue;
+        }
+        const uint8_t* edges = search.edge_table->edges[index.representative[c]][entry & ROTATION_MASK];
+        if ((right >= 0 && edges[RIGHT] != right) || (bottom >= 0 && edges[BOTTOM] != bottom)){
+            continue;
         }
 
-        pair<bool, string> tile2_found = isTileInMap(map_of_tiles, parent2_tile);
-        if (tile2_found.first){
-            trackedDuplicates2[tile2_found.second]++;
+        placeExactEntry(search, depth, entry);
+        if (searchExact(search, depth + 1)){
+            return true;
+        }
+        removeExactEntry(search, depth, entry);
+        if (search.aborted){
+            return false;
         }
     }
+    return false;
+}
 
-    //copy what is not between crossover points from parent2 to offspring2
-    int count_limit = TILES_IN_PUZZLE_COUNT - (crossover_point2 - crossover_point1);
-    for (int i = crossover_point2, j = i, count = 0; count < count_limit; i = (i + 1) % TILES_IN_PUZZLE_COUNT){
-        pair<bool, string> tile_found = isTileInMap(trackedDuplicates2, map_of_tiles.at(convertTileToString(parent2[i])));
-
-        if ((trackedDuplicates1[tile_found.second] < duplicatesMap.at(tile_found.second))){
-            copyTile(parent2[i], offspring2[j]);
-            trackedDuplicates1[tile_found.second]++;
-            j = (j + 1) % TILES_IN_PUZZLE_COUNT;
-            count++;
-        }
+/**
+ * @brief Arguments shared by the searchExactSubtree tasks of one solveExact call.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+struct EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::ExactContext {
+    const EdgeTable* edge_table;
+    const ExactIndex* index;
+    const vector<int>* paths;
+    int split_depth;
+    long long node_limit;
+    atomic<long long> node_count;
+    atomic<bool> stop;
+    atomic<int> solved_task;   // lowest task that found a solution, task count if none
+    Puzzle solution;
+};
 
+/**
+ * @brief Searches the subtree below one collected path.
+ *
+ * A task gives up as soon as a lower task has found a solution, so the solution kept is
+ * the one of the lowest solved task: the first in depth-first order, whatever the
+ * number of threads.
+ *
+ * @param task_index The task, which selects the path.
+ * @param context The ExactContext of the call.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::searchExactSubtree(int task_index, void* context){
+    ExactContext &args = *static_cast<ExactContext*>(context);
+    if (args.solved_task.load(memory_order_acquire) < task_index || args.stop.load(memory_order_relaxed)){
+        return;
     }
 
-    //copy what is not between crossover points from parent1 to offspring1
-    for (int i = crossover_point2, j = i, count = 0; count < count_limit; i = (i + 1) % TILES_IN_PUZZLE_COUNT){
-        pair<bool, string> tile_found = isTileInMap(trackedDuplicates2, map_of_tiles.at(convertTileToString(parent1[i])));
+    ExactSearch search;
+    initExactSearch(search, *args.edge_table, *args.index);
+    search.node_limit = args.node_limit;
+    search.node_count = &args.node_count;
+    search.stop = &args.stop;
+    search.solved_task = &args.solved_task;
+    search.task_index = task_index;
+
+    const int* path = args.paths->data() + (size_t)task_index * args.split_depth;
+    for (int depth = 0; depth < args.split_depth; depth++){
+        placeExactEntry(search, depth, path[depth]);
+    }
+    bool solved = searchExact(search, args.split_depth);
+    args.node_count.fetch_add(search.local_node_count, memory_order_relaxed);
+    if (!solved){
+        return;
+    }
 
-        if ((trackedDuplicates2[tile_found.second] < duplicatesMap.at(tile_found.second))){
-            copyTile(parent1[i], offspring1[j]);
-            trackedDuplicates2[tile_found.second]++;
-            j = (j + 1) % TILES_IN_PUZZLE_COUNT;
-            count++;
+    #pragma omp critical(exact_solution)
+    {
+        if (task_index < args.solved_task.load(memory_order_relaxed)){
+            copyPuzzle(search.puzzle, args.solution);
+            args.solved_task.store(task_index, memory_order_release);
         }
-
     }
-    freePuzzle(parent1);
-    freePuzzle(parent2);
-
 }
 
 /**
- * @brief Evolves a population of solutions over a specified number of generations.
+ * @brief Searches for a zero-mismatch arrangement of the input tiles.
  *
- * This function performs genetic algorithm operations such as crossover and mutation
- * on a population of solutions. It evaluates the fitness of the population after each
- * generation and tracks the minimum edge mismatch count.
+ * A depth-first search that fills the positions in row order, placing at each one
+ * only tiles whose top and left motifs match the tiles already above and on the left.
+ * The candidates come from a (top, left) index over the tile classes (input tiles
+ * equal up to rotation), and a bitset of the classes that still have unplaced tiles
+ * filters them, so duplicate input tiles are never tried twice at one position.
  *
- * @param population_arr A pointer to a 3D array representing the population of solutions.
- * @param NUM_OF_GENERATIONS The number of generations to evolve the population.
- * @param POPULATION_SIZE The size of the population.
+ * With split_depth > 0 the placements of the first split_depth positions are
+ * enumerated first, and the subtree below each one is a runWorkStealing task.
+ *
+ * @param solution Receives the solution, if one is found.
+ * @param edge_table The edge table built from the input puzzle.
+ * @param node_limit The most positions the search may try to fill, across all threads.
+ * @param node_count Receives the number of positions the search tried to fill.
+ * @param split_depth The number of leading positions enumerated before the search is
+ *                    split into parallel tasks; 0 searches on the calling thread.
+ * @return true if a solution was found. false with node_count < node_limit means
+ *         the puzzle has no solution.
  */
-void evolve(int*** population_arr, int NUM_OF_GENERATIONS, const int POPULATION_SIZE, const unordered_map<string, int> &duplicatesMap, const unordered_map<string, string> &map_of_tiles,pair<mt19937, uniform_int_distribution<int>> random, bool print_flag){
-    int min_edge_mismatch_count = INT_MAX;
-    int generations_performed = 1;
-    int stagnated_generation_count = 0;
-    int stagnation_threshold = 1000;
-    stagnation_threshold = max(10, (stagnation_threshold/POPULATION_SIZE) * stagnation_threshold);
-    const int MAX_MUTATION_RATE = 32;
-    const int MAX_MISMATCH = 112;
-    int mutation_rate = MAX_MUTATION_RATE;
-    float ratio = 0.25;
-    int ratio_adjusted_pop_size = POPULATION_SIZE * ratio;
-    ratio_adjusted_pop_size = ratio_adjusted_pop_size % 2 == 0 ? ratio_adjusted_pop_size : ratio_adjusted_pop_size + 1;
-    int** best_puzzle_so_far = allocatePuzzle();
-    int*** offspring_arr = allocatePopulation(ratio_adjusted_pop_size);
-    int current_edge_mismatch = min_edge_mismatch_count;
-    int last_gen_best_edge_mismatch = INT_MAX;
-    
-    // creating lookup table for variable mismatch_rate based on edge mismatch count
-    int mutation_rate_lut[MAX_MISMATCH];
-    float inverse_max_mismatch = 1.0f/MAX_MISMATCH;
-    for (int i = 0; i < MAX_MISMATCH; i++){
-        mutation_rate_lut[i] = max(3, (int)(i * inverse_max_mismatch * MAX_MUTATION_RATE));
+template<int WIDTH, int HEIGHT, int MOTIFS>
+bool EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::solveExact(Puzzle solution, const EdgeTable &edge_table, long long node_limit, long long &node_count, int split_depth){
+    ExactIndex index;
+    buildExactIndex(edge_table, index);
+
+    atomic<long long> shared_node_count(0);
+    atomic<bool> stop(false);
+    ExactSearch search;
+    initExactSearch(search, edge_table, index);
+    search.node_limit = node_limit;
+    search.node_count = &shared_node_count;
+    search.stop = &stop;
+
+    vector<int> paths;
+    if (split_depth > 0){
+        search.collect_depth = min(split_depth, TILES_IN_PUZZLE_COUNT);
+        search.collected_paths = &paths;
+    }
+    bool solved = searchExact(search, 0);
+    shared_node_count += search.local_node_count;
+    if (solved){
+        copyPuzzle(search.puzzle, solution);
     }
 
-    //while (min_edge_mismatch_count != 0){
-    while (generations_performed <= NUM_OF_GENERATIONS){
-        //refreshing random gen
-        random = getRandomGen();
-        
-        // Step 2: Evaluate Fitness
-        vector<pair<int, int>> sorted_index_by_fitness_vec = evaluateFitness(population_arr, POPULATION_SIZE); //<index, edgeMismatchCount>
-
-        if (sorted_index_by_fitness_vec.back().second < min_edge_mismatch_count){
-            best_puzzle_so_far = population_arr[sorted_index_by_fitness_vec.back().first];
-            
-            if (print_flag){
-                printPuzzle(best_puzzle_so_far);
-            }
+    if (!solved && !search.aborted && split_depth > 0){
+        ExactContext context;
+        context.edge_table = &edge_table;
+        context.index = &index;
+        context.paths = &paths;
+        context.split_depth = search.collect_depth;
+        context.node_limit = node_limit;
+        context.node_count.store(shared_node_count.load());
+        context.stop.store(false);
+        const int task_count = paths.size() / search.collect_depth;
+        context.solved_task.store(task_count);
+        context.solution = solution;
+
+        runWorkStealing(task_count, searchExactSubtree, &context);
+        solved = context.solved_task.load() < task_count;
+        shared_node_count.store(context.node_count.load());
+    }
 
-            if (sorted_index_by_fitness_vec.back().second <= 25){
-                savePuzzle(best_puzzle_so_far, sorted_index_by_fitness_vec.back().second);
-            }
-            stagnated_generation_count = 0;
-        }
+    node_count = shared_node_count.load();
+    return solved;
+}
 
-        // when fitness plateaus, will regenerate population with the best puzzle so far as the seed
-        if (++stagnated_generation_count == stagnation_threshold || stagnated_generation_count == stagnation_threshold * 10 || stagnated_generation_count == stagnation_threshold * 100){
-            generatePopulation(population_arr, best_puzzle_so_far, POPULATION_SIZE, random);
-            if (stagnated_generation_count == stagnation_threshold * 100){
-                stagnated_generation_count = 0;
-            }
-        }
+/**
+ * @brief Completes a near-solved puzzle by exact search over its mismatched positions.
+ *
+ * The positions with no mismatched edge are frozen and the rest are searched with the
+ * tiles currently on them, every placement matching the frozen tiles around it. When
+ * the search proves that the region cannot be completed, the frozen neighbours of the
+ * region are freed too and the search starts over, until the node budget runs out.
+ * Nothing is allocated, so evolve can call it between generations.
+ *
+ * @param puzzle The puzzle; replaced by the completion if one is found.
+ * @param edge_table The edge table built from the input puzzle.
+ * @param node_limit The most positions the searches may try to fill, across all regions.
+ * @param node_count Receives the number of positions the searches tried to fill.
+ * @return true if the puzzle now has no mismatch.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+bool EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::completeExact(Puzzle puzzle, const EdgeTable &edge_table, long long node_limit, long long &node_count){
+    ExactIndex index;
+    buildExactIndex(edge_table, index);
 
-        min_edge_mismatch_count = min(min_edge_mismatch_count, sorted_index_by_fitness_vec.back().second);
-        
-        // dynamically changing mutation_rate
-        if (sorted_index_by_fitness_vec.back().second != last_gen_best_edge_mismatch){
-            last_gen_best_edge_mismatch = sorted_index_by_fitness_vec.back().second;
-            mutation_rate = mutation_rate_lut[last_gen_best_edge_mismatch];
-        }
+    bool free[TILES_IN_PUZZLE_COUNT];
+    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+        free[i] = countLocalEdgeMismatch(puzzle, i, edge_table) > 0;
+    }
 
-        // Step 3: Termination Criteria (either best solution found or all generations elapsed)
-        if (min_edge_mismatch_count == 0){
+    atomic<long long> shared_node_count(0);
+    atomic<bool> stop(false);
+    ExactSearch search;
+    bool solved = false;
+    bool grown = true;
+    while (!solved && grown){
+        initExactSearch(search, edge_table, index);
+        search.node_limit = node_limit;
+        search.node_count = &shared_node_count;
+        search.stop = &stop;
+        restrictExactSearch(search, puzzle, free);
+        solved = searchExact(search, 0);
+        shared_node_count += search.local_node_count;
+        if (search.aborted){
             break;
         }
-        
-        // Step 4: Select Parents
-        pair<vector<int>, vector<int>> parents_and_worst_indexes_pair = selectParentsAndWorst(population_arr, POPULATION_SIZE, sorted_index_by_fitness_vec, ratio_adjusted_pop_size);
-        vector<int> parent_index_vec = parents_and_worst_indexes_pair.first;
-        vector<int> worst_index_vec = parents_and_worst_indexes_pair.second;
-
-        // Step 5: Offspring generation
-        crossover(population_arr, POPULATION_SIZE, parent_index_vec, offspring_arr, duplicatesMap, map_of_tiles, sorted_index_by_fitness_vec.back().second, random);
-        mutate(offspring_arr, ratio_adjusted_pop_size, random, mutation_rate);
-
-        // Step 6: Survivor Selection
-        selectSurvivorsAndReplace(population_arr, POPULATION_SIZE, worst_index_vec, offspring_arr);
 
-        if (print_flag){
-            cout << "GEN " << generations_performed << " " << " edge mismatch: "  << sorted_index_by_fitness_vec.back().second \
-            << " ... mutation rate: " << mutation_rate << " ... lowest edge mismatch: " << min_edge_mismatch_count << endl;
+        // the region has no completion, free its frozen neighbours as well
+        bool neighbour_free[TILES_IN_PUZZLE_COUNT];
+        copy(free, free + TILES_IN_PUZZLE_COUNT, neighbour_free);
+        grown = false;
+        for (int i = 0; i < TILES_IN_PUZZLE_COUNT && !solved; i++){
+            if (free[i]){
+                continue;
+            }
+            const int row = i / PUZZLE_WIDTH;
+            const int column = i % PUZZLE_WIDTH;
+            neighbour_free[i] = (row > 0 && free[i - PUZZLE_WIDTH]) || (row < PUZZLE_HEIGHT - 1 && free[i + PUZZLE_WIDTH])
+                             || (column > 0 && free[i - 1]) || (column < PUZZLE_WIDTH - 1 && free[i + 1]);
+            grown |= neighbour_free[i];
         }
-        
-        generations_performed++;
+        copy(neighbour_free, neighbour_free + TILES_IN_PUZZLE_COUNT, free);
     }
-    cout << "\n\nBest Puzzle with " << min_edge_mismatch_count << " edge mismatches:\n";
-    printPuzzle(best_puzzle_so_far);
-    freePuzzle(best_puzzle_so_far);
-    freePopulation(offspring_arr, POPULATION_SIZE * ratio);
+
+    if (solved){
+        copyPuzzle(search.puzzle, puzzle);
+    }
+    node_count = shared_node_count.load();
+    return solved;
 }
 
 /**
- * @brief Mutates a population of puzzles by performing random rotations and swaps.
- * 
- * This function iterates over each puzzle in the population and performs a series of 
- * random rotations and swaps on the tiles within each puzzle. The number of rotations 
- * and swaps is determined randomly for each puzzle.
- * 
- * @param population_arr A 3D array representing the population of puzzles.
- * @param POPULATION_SIZE The number of puzzles in the population.
- * 
- * The function uses the Mersenne Twister random number generator to ensure high-quality 
- * randomness. For each puzzle, it generates a random number of iterations and performs 
- * the following operations:
- * - Rotates a randomly selected tile to the left by one index.
- * - Swaps tiles within the puzzle.
+ * @brief Arguments shared by the crossoverPair tasks of one crossover call.
  */
-void mutate(int*** offspring_arr, const int POPULATION_SIZE, pair<mt19937, uniform_int_distribution<int>> random, int mutation_rate){
-    for (int i = 0; i < POPULATION_SIZE; i++){
-        // if (random.second(random.first) % 8 <= 2){
-        //     continue;
-        // }
-        //int num_iterations = random.second(random.first) % 32;
-        int num_iterations = random.second(random.first) % mutation_rate;
-        for (int j = 0; j < num_iterations; j++){
-            if(j % 2 == 0) {
-                swapTile(offspring_arr[i], random);
-            } else {
-                rotateToLeftByOneIndex(offspring_arr[i][random.second(random.first)]);
-            }
+template<int WIDTH, int HEIGHT, int MOTIFS>
+struct EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::CrossoverContext {
+    Population* population_arr;
+    const vector<int>* parent_index_vec;
+    const vector<int>* offspring_index_vec;
+    int min_edge_mismatch_count;
+    uint64_t seed;
+};
 
-        }
+/**
+ * @brief Builds the two offspring of one parent pair directly in their destination slots.
+ *
+ * Pair p combines parent slots 2p and size - 2p - 1, as the serial loop always did,
+ * and offspring k goes to slot offspring_index_vec[k].
+ *
+ * @param pair_index The pair.
+ * @param context The CrossoverContext of the call.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::crossoverPair(int pair_index, void* context){
+    const CrossoverContext &args = *static_cast<CrossoverContext*>(context);
+    Population &population_arr = *args.population_arr;
+    const vector<int> &parent_index_vec = *args.parent_index_vec;
+    const vector<int> &offspring_index_vec = *args.offspring_index_vec;
+
+    int i = 2 * pair_index;
+    int j = parent_index_vec.size() - i - 1;
+    int offspring1 = offspring_index_vec[i];
+    int offspring2 = offspring_index_vec[j];
+
+    // the one copy a child needs: its parent survives, so it cannot be built over it
+    copyPuzzle(population_arr[parent_index_vec[i]], population_arr[offspring1]);
+    copyPuzzle(population_arr[parent_index_vec[j]], population_arr[offspring2]);
+    population_arr.fitness[offspring1] = population_arr.fitness[parent_index_vec[i]];
+    population_arr.fitness[offspring2] = population_arr.fitness[parent_index_vec[j]];
+    population_arr.dirty[offspring1] = population_arr.dirty[parent_index_vec[i]];
+    population_arr.dirty[offspring2] = population_arr.dirty[parent_index_vec[j]];
+
+    // recombined offspring are left for refreshFitness to score
+    if (args.min_edge_mismatch_count <= 10){
+        Rng pair_rng = makeRng(args.seed, pair_index);
+        orderCrossover(population_arr[offspring1], population_arr[offspring2], pair_rng);
+        population_arr.dirty[offspring1] = true;
+        population_arr.dirty[offspring2] = true;
     }
 }
 
@@ -853,62 +3471,105 @@ void mutate(int*** offspring_arr, const int POPULATION_SIZE, pair<mt19937, unifo
  * a two-point crossover operation on each pair. The crossover is performed
  * only if there is a valid pair (i.e., the second individual in the pair exists).
  * 
- * @param population_arr A pointer to the population array, where each individual
- *                       is represented as a pointer to an array of integers.
+ * @param population_arr The population the parents are taken from and the offspring written to.
  * @param POPULATION_SIZE The size of the population array.
+ * @param offspring_index_vec The slots the offspring replace, disjoint from the parents.
  */
-void crossover(int*** population_arr, const int POPULATION_SIZE, const vector<int> &parent_index_vec, int*** offspring_arr, const unordered_map<string, int> &duplicatesMap, const unordered_map<string, string> &map_of_tiles, int min_edge_mismatch_count, pair<mt19937, uniform_int_distribution<int>> random){
-    int parent_index_vec_size = parent_index_vec.size();
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::crossover(Population &population_arr, const int POPULATION_SIZE, const vector<int> &parent_index_vec, const vector<int> &offspring_index_vec, int min_edge_mismatch_count, Rng &rng){
+    CrossoverContext context;
+    context.population_arr = &population_arr;
+    context.parent_index_vec = &parent_index_vec;
+    context.offspring_index_vec = &offspring_index_vec;
+    context.min_edge_mismatch_count = min_edge_mismatch_count;
+    // every pair gets its own stream, so the offspring do not depend on the thread count or scheduling
+    context.seed = nextRandom(rng);
+
+    // pairs are independent tasks; work stealing balances the much more expensive orderCrossover pairs
+    runWorkStealing(parent_index_vec.size() / 2, crossoverPair, &context);
+}
 
-    int** offspring1 = allocatePuzzle();
-    int** offspring2 = allocatePuzzle();
 
-    for (int i = 0; i < parent_index_vec_size; i += 2) {
-        if (i + 1 < parent_index_vec_size) {
-            copyPuzzle(population_arr[parent_index_vec[i]], offspring1);
-            copyPuzzle(population_arr[parent_index_vec[parent_index_vec_size - i -1]], offspring2);
+/**
+ * @brief Evaluates the fitness of a population of puzzle solutions.
+ *
+ * This function ranks a population of puzzle solutions by their cached fitness
+ * (edge mismatch count). Since the count is a small integer in
+ * [0, MAX_EDGE_MISMATCH_COUNT], the ranking is a stable counting sort in O(N) that
+ * only uses a stack histogram and the caller's vector, so nothing is allocated once
+ * the vector has grown to POPULATION_SIZE. If a fitness value falls outside that
+ * range, rankByFitnessPartial is used instead.
+ *
+ * @param population_arr The population of puzzle solutions.
+ * @param POPULATION_SIZE The size of the population.
+ * @param ratio_adjusted_pop_size The number of best and worst entries the caller needs.
+ * @param sorted_index_by_fitness_vec Receives the <index, fitness> pairs in descending
+ *                                    order of edge mismatch count.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::evaluateFitness(const Population &population_arr, const int POPULATION_SIZE, const int ratio_adjusted_pop_size, vector<pair<int, int>> &sorted_index_by_fitness_vec){
 
-            if (min_edge_mismatch_count <= 10){
-                orderCrossover(offspring1, offspring2, duplicatesMap, map_of_tiles, random);
-            }
+    sorted_index_by_fitness_vec.resize(POPULATION_SIZE);
 
-            copyPuzzle(offspring1, offspring_arr[i]);
-            copyPuzzle(offspring2, offspring_arr[parent_index_vec_size - i -1]);
+    int bucket_start[MAX_EDGE_MISMATCH_COUNT + 1] = {0};
+    for (int i = 0; i < POPULATION_SIZE; i++){
+        int fitness = population_arr.fitness[i];
+        if (fitness < 0 || fitness > MAX_EDGE_MISMATCH_COUNT){
+            rankByFitnessPartial(population_arr, POPULATION_SIZE, ratio_adjusted_pop_size, sorted_index_by_fitness_vec);
+            return;
         }
+        bucket_start[fitness]++;
     }
 
-    freePuzzle(offspring1);
-    freePuzzle(offspring2);
+    // turning the histogram into start offsets, highest edge mismatch count first
+    int offset = 0;
+    for (int fitness = MAX_EDGE_MISMATCH_COUNT; fitness >= 0; fitness--){
+        int count = bucket_start[fitness];
+        bucket_start[fitness] = offset;
+        offset += count;
+    }
 
+    for (int i = 0; i < POPULATION_SIZE; i++){
+        int fitness = population_arr.fitness[i];
+        sorted_index_by_fitness_vec[bucket_start[fitness]++] = make_pair(i, fitness);
+    }
 }
 
-
 /**
- * @brief Evaluates the fitness of a population of puzzle solutions.
+ * @brief Ranks only the best and worst entries of a population with nth_element.
  *
- * This function takes a population of puzzle solutions and evaluates their fitness
- * by counting the edge mismatches for each solution. It returns a vector of pairs,
- * where each pair contains the index of the solution and its corresponding fitness
- * value (edge mismatch count). The vector is sorted in descending order of fitness.
+ * Fallback for fitness values that do not fit the counting sort in evaluateFitness.
+ * Afterwards the first ratio_adjusted_pop_size entries are the worst individuals and
+ * the last ratio_adjusted_pop_size entries are the best, with the single best one at
+ * the back. The order within each group is unspecified.
  *
- * @param population_arr A 3D array representing the population of puzzle solutions.
+ * @param population_arr The population of puzzle solutions.
  * @param POPULATION_SIZE The size of the population.
- * @return A vector of pairs, where each pair contains the index of the solution and
- *         its corresponding fitness value, sorted in descending order of fitness.
+ * @param ratio_adjusted_pop_size The number of best and worst entries to separate out.
+ * @param sorted_index_by_fitness_vec Receives the partially ordered <index, fitness> pairs.
  */
-vector<pair<int, int>> evaluateFitness(int*** population_arr, const int POPULATION_SIZE){
-
-    vector<pair<int, int>> sorted_index_by_fitness_vec(POPULATION_SIZE);
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::rankByFitnessPartial(const Population &population_arr, const int POPULATION_SIZE, const int ratio_adjusted_pop_size, vector<pair<int, int>> &sorted_index_by_fitness_vec){
 
+    sorted_index_by_fitness_vec.resize(POPULATION_SIZE);
     for (int i = 0; i < POPULATION_SIZE; i++){
-        sorted_index_by_fitness_vec[i] = (make_pair(i, countEdgeMismatch(population_arr[i])));
+        sorted_index_by_fitness_vec[i] = make_pair(i, population_arr.fitness[i]);
     }
 
-    sort(sorted_index_by_fitness_vec.begin(), sorted_index_by_fitness_vec.end(), [](const pair<int, int>& a, const pair<int, int>& b) {
-        return a.second > b.second; // sort by edge mismatch count
-    });
+    auto worse_first = [](const pair<int, int>& a, const pair<int, int>& b) {
+        return a.second > b.second;
+    };
+    vector<pair<int, int>>::iterator begin = sorted_index_by_fitness_vec.begin();
+    vector<pair<int, int>>::iterator end = sorted_index_by_fitness_vec.end();
+    int k = min(ratio_adjusted_pop_size, POPULATION_SIZE / 2);
 
-    return sorted_index_by_fitness_vec;
+    if (k > 0){
+        nth_element(begin, begin + k, end, worse_first);
+        nth_element(begin + k, end - k, end, worse_first);
+    }
+    iter_swap(min_element(end - max(k, 1), end, [](const pair<int, int>& a, const pair<int, int>& b) {
+        return a.second < b.second;
+    }), end - 1);
 }
 
 /**
@@ -917,49 +3578,263 @@ vector<pair<int, int>> evaluateFitness(int*** population_arr, const int POPULATI
  * This function selects the top-ranking puzzles as parents and the bottom-ranking puzzles as the worst
  * based on their fitness values. The selection is done using a sorted index vector.
  * 
- * @param population_arr A 3D array representing the population of puzzles.
+ * @param population_arr The population of puzzles.
  * @param POPULATION_SIZE The total size of the population.
  * @param sorted_index_by_fitness_vec A vector of pairs where each pair contains an index and its corresponding fitness value, sorted by fitness.
  * @param ratio_adjusted_pop_size The number of top-ranking puzzles to select as parents and the number of bottom-ranking puzzles to select as worst.
  * 
- * @return A pair of vectors:
- *         - The first vector contains the indices of the selected parent puzzles.
- *         - The second vector contains the indices of the selected worst puzzles.
+ * @param parents_index_vec Receives the indices of the selected parent puzzles.
+ * @param worst_index_vec Receives the indices of the selected worst puzzles.
  */
-pair<vector<int>, vector<int>> selectParentsAndWorst(int*** population_arr, const int POPULATION_SIZE, const vector<pair<int, int>> &sorted_index_by_fitness_vec, const int ratio_adjusted_pop_size){
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::selectParentsAndWorst(const Population &population_arr, const int POPULATION_SIZE, const vector<pair<int, int>> &sorted_index_by_fitness_vec, const int ratio_adjusted_pop_size, vector<int> &parents_index_vec, vector<int> &worst_index_vec){
     
     // ratio is percentage of top ranking puzzles to select as parents
     int starting_point_parents = POPULATION_SIZE - ratio_adjusted_pop_size;
     int threshold_worst = ratio_adjusted_pop_size;
 
-    vector<int> parents_index_vec(ratio_adjusted_pop_size);
+    parents_index_vec.resize(ratio_adjusted_pop_size);
     for (int i = starting_point_parents; i < POPULATION_SIZE; i++){
         parents_index_vec[i - starting_point_parents] = sorted_index_by_fitness_vec[i].first;
     }
 
-    vector<int> worst_index_vec(ratio_adjusted_pop_size);
+    worst_index_vec.resize(ratio_adjusted_pop_size);
     for (int i = 0; i < threshold_worst; i++){
         worst_index_vec[i] = (sorted_index_by_fitness_vec[i].first);
     }
+}
+
+/**
+ * @brief Finds the worst individuals and the best one without ranking the population.
+ *
+ * @param population_arr The population, with every cached fitness up to date.
+ * @param POPULATION_SIZE The size of the population.
+ * @param worst_count The number of worst individuals to find.
+ * @param worst_index_vec Receives the worst individuals.
+ * @return The index of an individual with the lowest edge mismatch count.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::selectWorstUnranked(const Population &population_arr, const int POPULATION_SIZE, const int worst_count, vector<int> &worst_index_vec){
+    // one spare entry, so the collecting loop can store before it knows whether to keep
+    worst_index_vec.resize(worst_count + 1);
+
+    // out of range values are clamped, so they still land among the worst or the best
+    const int* fitness_arr = population_arr.fitness;
+    int fitness_count[MAX_EDGE_MISMATCH_COUNT + 1] = {0};
+    int best_index = 0;
+    int best_fitness = INT_MAX;
+    for (int i = 0; i < POPULATION_SIZE; i++){
+        int fitness = fitness_arr[i];
+        fitness_count[min(max(fitness, 0), MAX_EDGE_MISMATCH_COUNT)]++;
+        if (fitness < best_fitness){
+            best_fitness = fitness;
+            best_index = i;
+        }
+    }
+
+    // every individual above the threshold is among the worst, and the rest are taken from the threshold itself
+    int threshold = MAX_EDGE_MISMATCH_COUNT;
+    int above_threshold_count = 0;
+    while (threshold > 0 && above_threshold_count + fitness_count[threshold] < worst_count){
+        above_threshold_count += fitness_count[threshold];
+        threshold--;
+    }
+
+    // branch-free, since whether an individual is among the worst is unpredictable
+    int* worst = worst_index_vec.data();
+    int found = 0;
+    for (int i = 0; i < POPULATION_SIZE; i++){
+        worst[found] = i;
+        found += min(max(fitness_arr[i], 0), MAX_EDGE_MISMATCH_COUNT) > threshold;
+    }
+    for (int i = 0; found < worst_count; i++){
+        worst[found] = i;
+        found += min(max(fitness_arr[i], 0), MAX_EDGE_MISMATCH_COUNT) == threshold;
+    }
+    worst_index_vec.resize(worst_count);
+    return best_index;
+}
+
+/**
+ * @brief Returns a uniformly random individual that is not excluded.
+ *
+ * Callers exclude at most half the population, so this takes two draws on average.
+ */
+static int randomIncludedIndividual(const int POPULATION_SIZE, const vector<uint8_t> &excluded, Rng &rng){
+    int individual = randomBelow(rng, POPULATION_SIZE);
+    while (excluded[individual]){
+        individual = randomBelow(rng, POPULATION_SIZE);
+    }
+    return individual;
+}
+
+/**
+ * @brief Returns a uniformly random double in [0, 1).
+ */
+static double randomUnit(Rng &rng){
+    return (nextRandom(rng) >> 11) * (1.0 / (1ull << 53));
+}
+
+/**
+ * @brief Turns increasing spins of a roulette wheel into the individuals they land on.
+ *
+ * The wheel holds cumulative weights, and excluded individuals have no width, so a
+ * spin never lands on them. The parents come out in wheel order, so they are shuffled
+ * to pair parents from across the wheel.
+ *
+ * @param wheel The cumulative weights of the population.
+ * @param POPULATION_SIZE The size of the population.
+ * @param excluded The individuals that may not be picked.
+ * @param spin One spin per parent, in increasing order.
+ * @param parent_index_vec Receives the parents.
+ * @param rng The random stream used for the shuffle.
+ */
+static void readSortedSpins(const vector<double> &wheel, const int POPULATION_SIZE, const vector<uint8_t> &excluded, const double* spin, vector<int> &parent_index_vec, Rng &rng){
+    const int parent_count = parent_index_vec.size();
+    const double* cumulative_weight = wheel.data();
+    int* parents = parent_index_vec.data();
+    int individual = 0;
+    for (int p = 0; p < parent_count; p++){
+        while (individual < POPULATION_SIZE - 1 && (cumulative_weight[individual] <= spin[p] || excluded[individual])){
+            individual++;
+        }
+        parents[p] = individual;
+    }
 
-    return make_pair(parents_index_vec, worst_index_vec);
+    for (int p = parent_count - 1; p > 0; p--){
+        swap(parents[p], parents[randomBelow(rng, p + 1)]);
+    }
+}
+
+/**
+ * @brief Tournament selection: every parent is the best of TOURNAMENT_SIZE random individuals.
+ *
+ * @param population_arr The population, with every cached fitness up to date.
+ * @param POPULATION_SIZE The size of the population.
+ * @param excluded The individuals that may not be picked.
+ * @param parent_index_vec Receives the parents.
+ * @param rng The random stream the contestants are drawn from.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::tournamentSelection(const Population &population_arr, const int POPULATION_SIZE, const vector<uint8_t> &excluded, vector<int> &parent_index_vec, vector<double> & /*wheel*/, Rng &rng){
+    const int* fitness_arr = population_arr.fitness;
+    const int parent_count = parent_index_vec.size();
+    int* parents = parent_index_vec.data();
+    for (int p = 0; p < parent_count; p++){
+        int winner = randomIncludedIndividual(POPULATION_SIZE, excluded, rng);
+        for (int k = 1; k < TOURNAMENT_SIZE; k++){
+            int contestant = randomIncludedIndividual(POPULATION_SIZE, excluded, rng);
+            winner = fitness_arr[contestant] < fitness_arr[winner] ? contestant : winner;
+        }
+        parents[p] = winner;
+    }
 }
 
 /**
- * @brief Replaces the worst individuals in the population with new offspring.
+ * @brief Stochastic universal sampling, proportional to the number of matched edges.
  *
- * This function takes the worst individuals in the population, as indicated by their indices,
- * and replaces them with the corresponding offspring. The replacement is done in-place.
+ * @param population_arr The population, with every cached fitness up to date.
+ * @param POPULATION_SIZE The size of the population.
+ * @param excluded The individuals that may not be picked.
+ * @param parent_index_vec Receives the parents.
+ * @param wheel Receives the cumulative weights.
+ * @param rng The random stream the wheel is spun with.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::stochasticUniversalSampling(const Population &population_arr, const int POPULATION_SIZE, const vector<uint8_t> &excluded, vector<int> &parent_index_vec, vector<double> &wheel, Rng &rng){
+    const int parent_count = parent_index_vec.size();
+    if (parent_count == 0){
+        return;
+    }
+
+    // the population's cumulative weights, followed by the spins
+    wheel.resize(POPULATION_SIZE + parent_count);
+    const int* fitness_arr = population_arr.fitness;
+    const uint8_t* excluded_arr = excluded.data();
+    double* cumulative_weight = wheel.data();
+    double total = 0;
+    for (int i = 0; i < POPULATION_SIZE; i++){
+        total += excluded_arr[i] ? 0 : max(1, MAX_EDGE_MISMATCH_COUNT - fitness_arr[i] + 1);
+        cumulative_weight[i] = total;
+    }
+
+    // parent_count equally spaced pointers from one random offset, read in a single pass
+    double* spin = wheel.data() + POPULATION_SIZE;
+    double spacing = total / parent_count;
+    double offset = spacing * randomUnit(rng);
+    for (int p = 0; p < parent_count; p++){
+        spin[p] = offset + p * spacing;
+    }
+    readSortedSpins(wheel, POPULATION_SIZE, excluded, spin, parent_index_vec, rng);
+}
+
+/**
+ * @brief Roulette-wheel selection weighted by rank.
  *
- * @param population_arr A pointer to the 3D array representing the current population.
+ * @param population_arr The population, with every cached fitness up to date.
  * @param POPULATION_SIZE The size of the population.
- * @param worst_index_vec A vector containing the indices of the worst individuals in the population.
- * @param offspring_arr A pointer to the 3D array representing the new offspring.
+ * @param excluded The individuals that may not be picked.
+ * @param parent_index_vec Receives the parents.
+ * @param wheel Receives the cumulative weights.
+ * @param rng The random stream the wheel is spun with.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::rankRouletteSelection(const Population &population_arr, const int POPULATION_SIZE, const vector<uint8_t> &excluded, vector<int> &parent_index_vec, vector<double> &wheel, Rng &rng){
+    // the rank weight of an edge mismatch count is one plus the number of included individuals with more
+    const int* fitness_arr = population_arr.fitness;
+    int64_t rank_weight[MAX_EDGE_MISMATCH_COUNT + 1] = {0};
+    for (int i = 0; i < POPULATION_SIZE; i++){
+        rank_weight[min(max(fitness_arr[i], 0), MAX_EDGE_MISMATCH_COUNT)] += !excluded[i];
+    }
+    int64_t worse_count = 0;
+    for (int fitness = MAX_EDGE_MISMATCH_COUNT; fitness >= 0; fitness--){
+        int64_t count = rank_weight[fitness];
+        rank_weight[fitness] = worse_count + 1;
+        worse_count += count;
+    }
+
+    // the population's cumulative weights, followed by the spins
+    const int parent_count = parent_index_vec.size();
+    wheel.resize(POPULATION_SIZE + parent_count + 1);
+    const uint8_t* excluded_arr = excluded.data();
+    double* cumulative_weight = wheel.data();
+    double total = 0;
+    for (int i = 0; i < POPULATION_SIZE; i++){
+        total += excluded_arr[i] ? 0 : rank_weight[min(max(fitness_arr[i], 0), MAX_EDGE_MISMATCH_COUNT)];
+        cumulative_weight[i] = total;
+    }
+
+    // independent spins, generated already sorted as normalized sums of exponential gaps,
+    // so the wheel is read in one pass instead of one binary search per parent
+    double* gap_sum = wheel.data() + POPULATION_SIZE;
+    double sum = 0;
+    for (int p = 0; p <= parent_count; p++){
+        sum -= log(1.0 - randomUnit(rng));
+        gap_sum[p] = sum;
+    }
+    for (int p = 0; p < parent_count; p++){
+        gap_sum[p] = gap_sum[p] / sum * total;
+    }
+    readSortedSpins(wheel, POPULATION_SIZE, excluded, gap_sum, parent_index_vec, rng);
+}
+
+/**
+ * @brief Returns the operator of a selection method.
+ *
+ * @param selection_method The selection method.
+ * @return The operator, or null for TRUNCATION_SELECTION, which needs the ranking.
  */
-void selectSurvivorsAndReplace(int*** population_arr, const int POPULATION_SIZE, const vector<int> &worst_index_vec, int*** offspring_arr){
-    int size = worst_index_vec.size();
-    for (int i = 0; i < size; i++){
-        copyPuzzle(offspring_arr[i], population_arr[worst_index_vec[i]]);
+template<int WIDTH, int HEIGHT, int MOTIFS>
+typename EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::ParentSelector EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::getParentSelector(SelectionMethod selection_method){
+    switch (selection_method){
+        case TOURNAMENT_SELECTION:
+            return tournamentSelection;
+        case SUS_SELECTION:
+            return stochasticUniversalSampling;
+        case RANK_ROULETTE_SELECTION:
+            return rankRouletteSelection;
+        default:
+            return nullptr;
     }
 }
 
@@ -967,54 +3842,46 @@ void selectSurvivorsAndReplace(int*** population_arr, const int POPULATION_SIZE,
  * @brief Copies the contents of one puzzle to another.
  * 
  * This function copies the contents of the source puzzle to the destination puzzle.
- * Both puzzles are assumed to be 2D arrays with dimensions TILES_IN_PUZZLE_COUNT x TILE_SIZE.
+ * Both puzzles are contiguous blocks of TILES_IN_PUZZLE_COUNT genes, so the copy
+ * is a single memcpy.
  * 
- * @param source_puzzle A pointer to the source puzzle (2D array) to copy from.
- * @param dest_puzzle A pointer to the destination puzzle (2D array) to copy to.
+ * @param source_puzzle The source puzzle to copy from.
+ * @param dest_puzzle The destination puzzle to copy to.
  */
-void copyPuzzle(int** source_puzzle, int** dest_puzzle){
-    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
-        for (int j = 0; j < TILE_SIZE; j++){
-            dest_puzzle[i][j] = source_puzzle[i][j];
-        }
-    }
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::copyPuzzle(const Gene* source_puzzle, Puzzle dest_puzzle){
+    memcpy(dest_puzzle, source_puzzle, TILES_IN_PUZZLE_COUNT * sizeof(Gene));
 }
 
 /**
- * @brief Copies the contents of one tile to another.
+ * @brief Copies the tile placed at one position to another.
  * 
- * This function copies the contents of the source tile array to the destination tile array.
- * It assumes that both arrays have a size of TILE_SIZE.
+ * This function copies the gene (tile index and rotation) of the source position
+ * to the destination position, which is a single byte store.
  * 
- * @param source_tile Pointer to the source tile array.
- * @param dest_tile Pointer to the destination tile array.
+ * @param source_tile The source gene.
+ * @param dest_tile The destination gene.
  */
-void copyTile(int* source_tile, int* dest_tile){
-    for (int i = 0; i < TILE_SIZE; i++){
-        dest_tile[i] = source_tile[i];
-    }
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::copyTile(Gene source_tile, Gene &dest_tile){
+    dest_tile = source_tile;
 }
 
 /**
  * @brief Copies a source puzzle into each element of a destination population.
  * 
  * This function iterates over a population array and copies the source puzzle 
- * into each individual in the population. The population is represented as a 
- * 3D array where each individual is a 2D array (puzzle).
+ * into each individual in the population.
  * 
- * @param destination_population A 3D array representing the population where 
- *        each individual is a 2D array (puzzle) to be filled with the source puzzle.
+ * @param destination_population The population where each individual is to be
+ *        filled with the source puzzle.
  * @param POPULATION_SIZE The number of individuals in the population.
- * @param source_puzzle A 2D array representing the puzzle to be copied into 
- *        each individual of the population.
+ * @param source_puzzle The puzzle to be copied into each individual of the population.
  */
-void writePuzzleIntoPopulation(int*** destination_population, int POPULATION_SIZE, int** source_puzzle){
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::writePuzzleIntoPopulation(Population &destination_population, const int POPULATION_SIZE, Puzzle source_puzzle){
     for (int i = 0; i < POPULATION_SIZE; i++){
-        for (int j = 0; j < TILES_IN_PUZZLE_COUNT; j++){
-            for (int p = 0; p < TILE_SIZE; p++){
-                destination_population[i][j][p] = source_puzzle[j][p];
-            }
-        }
+        copyPuzzle(source_puzzle, destination_population[i]);
     }
 }
 
@@ -1022,18 +3889,21 @@ void writePuzzleIntoPopulation(int*** destination_population, int POPULATION_SIZ
  * @brief Prints the puzzle in a formatted manner.
  * 
  * This function takes a 2D array representing a puzzle and prints it to the console.
- * Each tile in the puzzle is printed in a row, and a new line is started after every 8 tiles.
+ * Each tile in the puzzle is printed in a row, and a new line is started after every PUZZLE_WIDTH tiles.
  * 
- * @param puzzle A 2D array representing the puzzle, where each sub-array is a tile.
+ * @param puzzle The puzzle to print.
+ * @param edge_table The edge table used to convert genes back to the four-digit format.
  */
-void printPuzzle(int** puzzle){
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::printPuzzle(const Gene* puzzle, const EdgeTable &edge_table){
+    Tile tiles[TILES_IN_PUZZLE_COUNT];
+    decodePuzzle(puzzle, edge_table, tiles);
+
     for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
-        if (i % 8 == 0){
+        if (i % PUZZLE_WIDTH == 0){
             cout << endl;
         }
-        for (int j = 0; j < TILE_SIZE; j++){
-            cout << puzzle[i][j];
-        }
+        cout << convertTileToString(tiles[i]);
         cout << " ";
     }
     cout << "\n\n";
@@ -1046,15 +3916,17 @@ void printPuzzle(int** puzzle){
  * It then generates a filename based on the current date and time, and the
  * provided edge mismatch count. The puzzle state is written to this file.
  *
- * @param puzzle A 2D array representing the puzzle state.
+ * @param puzzle The puzzle state.
+ * @param edge_table The edge table used to convert genes back to the four-digit format.
  * @param edge_mismatch_count The count of edge mismatches in the puzzle.
  *
- * @note The function assumes that the puzzle is a square grid with a size
- *       defined by TILES_IN_PUZZLE_COUNT and TILE_SIZE.
+ * @note The puzzle is written as PUZZLE_HEIGHT lines of PUZZLE_WIDTH tiles, the same
+ *       format readInput expects.
  * @note The function will output an error message to std::cerr if it fails
  *       to create the directory or open the file for writing.
  */
-void savePuzzle(int** puzzle, int edge_mismatch_count) {
+template<int WIDTH, int HEIGHT, int MOTIFS>
+void EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::savePuzzle(const Gene* puzzle, const EdgeTable &edge_table, int edge_mismatch_count) {
     #ifdef _WIN32
         int status = _mkdir("output");
     #else
@@ -1083,18 +3955,26 @@ void savePuzzle(int** puzzle, int edge_mismatch_count) {
         return;
     }
 
+    Tile tiles[TILES_IN_PUZZLE_COUNT];
+    decodePuzzle(puzzle, edge_table, tiles);
+
     file << "placeholder name id placeholder name id\n";
     for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++) {
-        if (i % 8 == 0 && i != 0) {
+        if (i % PUZZLE_WIDTH == 0 && i != 0) {
             file << endl;
         }
-        for (int j = 0; j < TILE_SIZE; j++) {
-            file << puzzle[i][j];
-        }
-        if ((i + 1) % 8 != 0) {
+        file << convertTileToString(tiles[i]);
+        if ((i + 1) % PUZZLE_WIDTH != 0) {
             file << " ";
         }
     }
     file << "\n\n";
     file.close();
-}
\ No newline at end of file
+}
+
+// every geometry of EVOL_PUZZLE_FOR_EACH_SIZE, with both motif capacities
+#define EVOL_PUZZLE_INSTANTIATE(W, H) \
+    template struct EvolPuzzle<W, H, SMALL_MOTIF_COUNT>; \
+    template struct EvolPuzzle<W, H, MAX_MOTIF_COUNT>;
+EVOL_PUZZLE_FOR_EACH_SIZE(EVOL_PUZZLE_INSTANTIATE)
+#undef EVOL_PUZZLE_INSTANTIATE
@@ -14,12 +14,35 @@
 #include <algorithm>
 #include <utility>
 #include <cmath>
+#include <cstring>
+#include <atomic>
+#include <new>
+#include <memory>
+#include <type_traits>
+#include <stdexcept>
 
 #ifdef _WIN32
     #include <direct.h> // windows mkdir
 #else
     #include <sys/stat.h> // posix mkdir
     #include <sys/types.h> 
+    #include <sys/mman.h> // posix shared memory for the multi-process island model
+    #include <sys/wait.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+    #include <omp.h> // built with -fopenmp
+#endif
+
+// AVX2 kernels are compiled with a per-function target attribute and selected at
+// runtime, so the program still runs on CPUs without AVX2 (see HAS_AVX2_KERNELS).
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define EVOL_PUZZLE_X86_DISPATCH
+    #define EVOL_PUZZLE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+    #define EVOL_PUZZLE_TARGET_AVX2
 #endif
 
 using namespace std;
@@ -48,449 +71,1800 @@ represents the left edge.
 constexpr int TILE_SIZE = 4;
 
 /**
- * @brief The number of tiles in the puzzle.
+ * @brief The size in bytes of a cache line.
  * 
- * This constant defines the total count of tiles present in the puzzle.
- * It is used throughout the code to ensure consistency when referring to
- * the number of tiles in the puzzle.
+ * Individuals in a population are aligned to and padded to a multiple of this
+ * value so that no two individuals share a cache line.
  */
-constexpr int TILES_IN_PUZZLE_COUNT = 64;
+constexpr int CACHE_LINE_SIZE = 64;
 
 /**
- * @brief Generates a random number generator and a uniform integer distribution.
- * 
- * This function uses the high-resolution clock to seed a Mersenne Twister 
- * random number generator. It also creates a uniform integer distribution 
- * ranging from 0 to TILES_IN_PUZZLE_COUNT - 1.
+ * @brief The most mutation moves for which mutate tracks fitness with O(1) deltas.
  * 
- * @return A pair consisting of a seeded mt19937 generator and a uniform 
- * integer distribution.
+ * Each delta looks at up to 16 edges, so a handful of moves already costs more than
+ * rescoring the individual in a batch; beyond this the individual is marked dirty.
  */
-pair<mt19937, uniform_int_distribution<int>> getRandomGen();
+constexpr int MAX_DELTA_TRACKED_MOVES = 3;
 
 /**
- * @brief Rotates the elements of the given array to the left by one index.
- * 
- * This function takes an array and shifts all its elements one position to the left.
- * The first element of the array is moved to the last position.
- * 
- * @param arr The array to be rotated. The array should have a size of TILE_SIZE.
+ * @brief Returns the number of bits needed to store the values 0..max_value.
  */
-void rotateToLeftByOneIndex(int[]);
+constexpr int bitWidth(int max_value){
+    return max_value <= 1 ? 1 : 1 + bitWidth(max_value >> 1);
+}
 
 /**
- * @brief Rotates the elements of the given vector to the left by one index.
- *
- * This function takes a reference to a vector of integers and rotates its elements
- * to the left by one position. The first element of the vector is moved to the end.
- *
- * @param tile A reference to a vector of integers to be rotated.
- * @return A vector of integers after rotating the elements to the left by one index.
+ * @brief Indices of the edges of a tile, in the order they appear in the input file.
  */
-vector<int> rotateToLeftByOneIndexReturn(vector<int> &tile);
+enum Edge { TOP = 0, RIGHT = 1, BOTTOM = 2, LEFT = 3 };
 
 /**
- * @brief Converts an array of integers to a vector of integers.
- * 
- * This function takes an array of integers and converts it into a 
- * std::vector<int> of the same size. The size of the array is 
- * determined by the constant TILE_SIZE.
- * 
- * @param arr The input array of integers to be converted.
- * @return std::vector<int> A vector containing the elements of the input array.
+ * @brief The number of low bits of a gene holding the rotation of its tile.
  */
-vector<int> convertTileToVector(int arr[]);
+constexpr int ROTATION_BITS = 2;
 
 /**
- * @brief Converts a vector of integers representing a tile into a string.
- * 
- * This function takes a vector of integers and concatenates each integer
- * into a single string. The size of the vector is assumed to be TILE_SIZE.
- * 
- * @param vec A vector of integers representing the tile.
- * @return A string representation of the tile.
+ * @brief Mask selecting the rotation of a gene.
  */
-string convertTileToString(vector<int> vec);
+constexpr int ROTATION_MASK = (1 << ROTATION_BITS) - 1;
 
 /**
- * @brief Converts an array of integers representing a tile to a string.
- * 
- * This function takes an array of integers and concatenates each integer
- * into a single string. The size of the array is determined by the constant
- * TILE_SIZE.
+ * @brief Returns the character a motif is written as in the input and output files.
  * 
- * @param arr An array of integers representing the tile.
- * @return A string representation of the tile.
+ * Motifs 0-9 are written as digits and the motifs above 9 as the letters a-z.
  */
-string convertTileToString(int arr[]);
+inline char motifToChar(int motif){
+    return (char)(motif < 10 ? '0' + motif : 'a' + motif - 10);
+}
 
 /**
- * @brief Records duplicate tiles in a puzzle.
- *
- * This function takes a 2D array representing a puzzle and records the number of duplicate tiles.
- * Each tile is converted to a vector and then to a string representation. The function considers
- * all possible rotations of each tile to identify duplicates.
- *
- * @param puzzle A 2D array representing the puzzle.
- * @return An unordered_map where the keys are string representations of tiles and the values are the counts of duplicates.
+ * @brief Returns the motif written as the given character (see motifToChar), or -1.
  */
-unordered_map<string, int> recordDuplicateTiles(int** puzzle);
+inline int charToMotif(char c){
+    if (c >= '0' && c <= '9'){
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'z'){
+        return c - 'a' + 10;
+    }
+    return -1;
+}
 
 /**
- * @brief Builds a map of tiles from a given puzzle.
+ * @brief The motif capacity of the compact instantiations: 3 bits per edge, 12 per tile.
  *
- * This function takes a 2D array representing a puzzle and constructs an unordered map
- * where each unique tile (and its rotations) is mapped to its string representation.
- *
- * @param puzzle A 2D array of integers representing the puzzle tiles.
- * @return An unordered_map where the key is the string representation of a tile (or its rotations)
- *         and the value is the original string representation of the tile.
+ * Inputs with at most this many motifs (the 8x8 assignment puzzle has 7) run on
+ * EvolPuzzle<W, H, SMALL_MOTIF_COUNT>, the others on EvolPuzzle<W, H, MAX_MOTIF_COUNT>.
  */
-unordered_map <string, string> buildMapOfTiles(int** puzzle);
+constexpr int SMALL_MOTIF_COUNT = 8;
 
 /**
- * @brief Builds a map of tile strings and their counts from a given puzzle.
- *
- * This function processes a 2D puzzle array and generates a map where each key is a string 
- * representation of a tile (or its rotations) and the value is the count of how many times 
- * that tile (or its rotations) appears in the specified range of the puzzle.
- *
- * @param puzzle A 2D array representing the puzzle.
- * @param start_index The starting index of the range in the puzzle to process.
- * @param end_index The ending index of the range in the puzzle to process.
- * @return An unordered_map where keys are string representations of tiles and values are their counts.
+ * @brief The most motifs an input can use: they are written as one character, 0-9 then a-z.
  */
-unordered_map <string, int> buildMapOfTiles(int** puzzle, const int start_index, const int end_index);
+constexpr int MAX_MOTIF_COUNT = 36;
 
 /**
- * @brief Checks if any rotation of a given tile is present in the provided map.
- *
- * This function takes a map and a tile, generates all possible rotations of the tile,
- * and checks if any of these rotations exist in the map. If a match is found, it returns
- * a pair containing true and the matching rotation string. If no match is found, it returns
- * a pair containing false and an empty string.
- *
- * @param map_to_search The unordered map to search for the tile rotations.
- * @param tile The tile represented as a vector of integers.
- * @return A pair where the first element is a boolean indicating if a match was found,
- *         and the second element is the matching rotation string if a match was found,
- *         or an empty string if no match was found.
+ * @brief How the first population of a run is generated.
  */
-pair<bool, string> isTileInMap(const unordered_map<string, int> &map_to_search, vector<int> tile);
+enum InitializationMethod {
+    RANDOM_INITIALIZATION, // random swaps and rotations of the input order (generatePopulation)
+    GREEDY_INITIALIZATION  // randomized greedy construction (generateGreedyPopulation)
+};
 
 /**
- * @brief Checks if a tile is present in the given map.
- * 
- * This function searches for a specified tile in an unordered map and returns
- * a pair indicating whether the tile was found and the tile itself if found.
- * 
- * @param map_to_search The unordered map to search within.
- * @param tile The tile to search for in the map.
- * @return A pair where the first element is a boolean indicating if the tile
- *         was found (true if found, false otherwise), and the second element
- *         is the tile itself if found, or an empty string if not found.
+ * @brief The number of individuals drawn for each tournament of tournamentSelect.
  */
-pair<bool, string> isTileInMap(const unordered_map<string, int> &map_to_search, string tile);
+constexpr int TOURNAMENT_SIZE = 3;
 
 /**
- * @brief Checks if a tile is present in the given map and returns its corresponding value.
- *
- * This function searches for a specified tile in the provided unordered map. If the tile is found,
- * it returns a pair containing `true` and the value associated with the tile. If the tile is not found,
- * it returns a pair containing `false` and an empty string.
- *
- * @param map_to_search The unordered map to search for the tile.
- * @param tile The tile to search for in the map.
- * @return A pair where the first element is a boolean indicating whether the tile was found,
- *         and the second element is the value associated with the tile if found, or an empty string if not found.
+ * @brief How evolve picks the parents of each generation.
  */
-pair<bool, string> isTileInMap(const unordered_map<string, string> &map_to_search, string tile);
+enum SelectionMethod {
+    TRUNCATION_SELECTION,   // the best quarter of the ranked population, the default
+    TOURNAMENT_SELECTION,   // the best of TOURNAMENT_SIZE random individuals, per parent
+    SUS_SELECTION,          // stochastic universal sampling, proportional to the matched edges
+    RANK_ROULETTE_SELECTION // roulette wheel weighted by rank
+};
 
 /**
- * @brief Swaps two random tiles in a 2D array.
- *
- * This function selects two distinct random indices within the range of the puzzle tiles
- * and swaps the tiles at these indices. The random selection is seeded using a high-resolution
- * clock to ensure variability.
- *
- * @param arr A pointer to a 2D array representing the puzzle tiles.
+ * @brief How the offspring of each generation are improved after mutation, if at all.
+ */
+enum LocalSearchMethod {
+    NO_LOCAL_SEARCH,                // offspring are left as mutate made them, the default
+    FIRST_IMPROVEMENT_LOCAL_SEARCH, // hill climbing that keeps the first improving move it finds
+    BEST_IMPROVEMENT_LOCAL_SEARCH   // hill climbing that keeps the best move of each pass
+};
+
+/**
+ * @brief The best edge mismatch count at or below which the local-search stage runs.
  *
- * @note The array is assumed to have a size of TILES_IN_PUZZLE_COUNT x TILE_SIZE.
+ * Like the order crossover, hill climbing only pays off once the population is close
+ * to a solution; before that, mutation and crossover improve it faster.
  */
-void swapTile(int** arr);
+constexpr int LOCAL_SEARCH_THRESHOLD = 10;
 
 /**
- * @brief Reads a puzzle input from a file and stores it in a 2D array.
- * 
- * This function reads the contents of the specified file, parses it into a 2D array of integers,
- * and stores the result in the provided 2D array `puzzle`.
- * 
- * @param filename The path to the input file containing the puzzle data.
- * @param puzzle A pointer to a 2D array where the parsed puzzle data will be stored.
- * 
- * @note The input file should contain numbers arranged in a specific format that can be parsed
- *       into a 2D array of integers.
- * @note The dimensions of the `puzzle` array should match the expected dimensions defined by
- *       `TILES_IN_PUZZLE_COUNT` and `TILE_SIZE`.
- * 
- * @throws runtime_error If the file cannot be opened.
+ * @brief The most swap and rotation moves the local-search stage scores per offspring.
  */
-void readInput(string, int** puzzle);
+constexpr int LOCAL_SEARCH_MOVE_BUDGET = 4096;
 
 /**
- * @brief Allocates memory for a population of individuals.
- * 
- * This function allocates a 3D array to represent a population of individuals
- * for a genetic algorithm or evolutionary computation. Each individual in the 
- * population is represented by a 2D array.
- * 
- * @param population_size The number of individuals in the population.
- * @return A pointer to the allocated 3D array representing the population.
+ * @brief The most time, in microseconds, the local-search stage spends on one offspring.
  */
-int*** allocatePopulation(int population_size);
+constexpr int LOCAL_SEARCH_TIME_BUDGET_US = 200;
 
 /**
- * @brief Allocates memory for a puzzle.
- * 
- * This function dynamically allocates a 2D array to represent a puzzle.
- * The puzzle is represented as an array of pointers, where each pointer
- * points to an array of integers. The size of the puzzle and the size
- * of each tile are determined by the constants TILES_IN_PUZZLE_COUNT
- * and TILE_SIZE, respectively.
- * 
- * @return int** A pointer to the allocated 2D array representing the puzzle.
+ * @brief The default node budget of the exact solver (--exact-nodes overrides it).
  */
-int** allocatePuzzle();
+constexpr long long EXACT_NODE_LIMIT = 20000000000LL;
 
 /**
- * @brief Frees the memory allocated for a 2D puzzle array.
- * 
- * This function deallocates the memory for each row of the puzzle
- * and then deallocates the memory for the array of row pointers.
- * 
- * @param puzzle A pointer to the 2D array representing the puzzle.
+ * @brief The number of leading positions the exact solver enumerates before splitting its search into parallel tasks.
  */
-void freePuzzle(int** puzzle);
+constexpr int EXACT_SPLIT_DEPTH = 2;
 
 /**
- * @brief Frees the memory allocated for a population of puzzle solutions.
- *
- * This function deallocates the memory used by a 3D array representing a population
- * of puzzle solutions. It iterates through each solution in the population, freeing
- * the memory allocated for each tile and then freeing the memory allocated for each
- * solution. Finally, it frees the memory allocated for the population array itself.
+ * @brief The best edge mismatch count at or below which evolve tries to complete its best individual exactly.
+ */
+constexpr int EXACT_COMPLETION_THRESHOLD = 6;
+
+/**
+ * @brief A node budget for one exact completion that solves the 8x8 input reliably (see --completion-nodes).
+ */
+constexpr long long EXACT_COMPLETION_NODE_LIMIT = 1000000;
+
+/**
+ * @brief Generations between two exact completions while the best edge mismatch count stalls.
+ */
+constexpr int EXACT_COMPLETION_INTERVAL = 100;
+
+/**
+ * @brief How the temperature of the annealing engine falls from its initial to its final value.
+ */
+enum CoolingSchedule {
+    GEOMETRIC_COOLING, // falls by the same factor every generation, the default
+    LINEAR_COOLING,    // falls by the same amount every generation
+    LUNDY_MEES_COOLING // T / (1 + beta T) every generation: fast while hot, slow once cold
+};
+
+/**
+ * @brief Settings of an annealing run (see anneal).
+ */
+struct AnnealingSettings {
+    CoolingSchedule schedule;
+    double initial_temperature;
+    double final_temperature;
+    int reheat_interval; // generations without a new best before the temperature is raised again, 0 for never
+    int replica_count;   // 1 for plain annealing, more for parallel tempering with replica exchange
+};
+
+/**
+ * @brief The default initial temperature of the annealing engine, in edge mismatches.
+ */
+constexpr double ANNEALING_INITIAL_TEMPERATURE = 0.7;
+
+/**
+ * @brief The default final temperature of the annealing engine, in edge mismatches.
+ */
+constexpr double ANNEALING_FINAL_TEMPERATURE = 0.1;
+
+/**
+ * @brief The fraction of the initial temperature a reheat goes back to.
+ */
+constexpr double ANNEALING_REHEAT_FRACTION = 0.5;
+
+/**
+ * @brief How islands of an island-model run pass migrants to each other.
+ */
+enum MigrationTopology {
+    RING_TOPOLOGY,            // island k sends to island k + 1
+    FULLY_CONNECTED_TOPOLOGY, // every island sends to every other island
+    RANDOM_TOPOLOGY           // every migration goes to one randomly chosen other island
+};
+
+/**
+ * @brief The number of migrants a migration queue holds before new ones are dropped.
+ */
+constexpr int MIGRATION_QUEUE_CAPACITY = 16;
+
+/**
+ * @brief Lifecycle of an island running in its own process.
+ */
+enum IslandState {
+    ISLAND_STARTING, // not registered yet, receives no migrants
+    ISLAND_RUNNING,  // registered and evolving
+    ISLAND_FINISHED, // exited normally, its result is in its ProcessSlot
+    ISLAND_CRASHED   // exited abnormally, as seen by the launcher
+};
+
+/**
+ * @brief A xoshiro256** random number stream.
  *
- * @param population_arr A pointer to a 3D array representing the population of puzzle solutions.
- *                       The array is of size [population_size][TILES_IN_PUZZLE_COUNT][TILE_SIZE].
- * @param population_size The number of solutions in the population.
+ * The whole state is 32 bytes, so a stream is cheap to create for every thread or
+ * individual and is always passed by reference so operators advance the caller's
+ * stream. Streams are created with makeRng from the run seed and a stream id, which
+ * makes a run reproducible from its seed.
  */
-void freePopulation(int*** population_arr, int population_size);
+struct Rng {
+    uint64_t state[4];
+};
 
 /**
- * @brief Generates an initial population for the puzzle solver.
+ * @brief Advances a SplitMix64 state and returns the next output.
  *
- * This function initializes a population array with a given size, where each 
- * individual in the population is a variation of the initial puzzle configuration.
+ * Used to expand a seed and stream id into a well-mixed xoshiro256** state.
  *
- * @param population_arr A 3D array to store the generated population. The first 
- *                       dimension represents the population size, the second 
- *                       dimension represents the tiles in the puzzle, and the 
- *                       third dimension represents the size of each tile.
- * @param arr A 2D array representing the initial puzzle configuration. The first 
- *            dimension represents the tiles in the puzzle, and the second dimension 
- *            represents the size of each tile.
- * @param population_size The number of individuals in the population.
+ * @param x The SplitMix64 state.
+ * @return The next 64-bit output.
  */
-void generatePopulation(int*** population_arr, int** puzzle, int population_size, pair<mt19937, uniform_int_distribution<int>> random);
+inline uint64_t splitMix64(uint64_t &x){
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
 
 /**
- * @brief Counts the number of edge mismatches in a given puzzle.
+ * @brief Returns the next 64 random bits of a stream.
  *
- * This function checks the mismatches between adjacent tiles in a puzzle.
- * It considers both the left and top edges of each tile and compares them
- * with the corresponding edges of the neighboring tiles.
- *
- * @param puzzle A 2D array representing the puzzle, where each tile is an array of edges.
- *               The edges are assumed to be in the following order:
- *               [top, right, bottom, left].
- * @return The total number of edge mismatches in the puzzle.
+ * @param rng The stream to advance.
+ * @return 64 uniformly distributed bits.
  */
-int countEdgeMismatch(int** puzzle);
+inline uint64_t nextRandom(Rng &rng){
+    uint64_t* s = rng.state;
+    uint64_t x = s[1] * 5;
+    uint64_t result = ((x << 7) | (x >> 57)) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
 
+    return result;
+}
 
 /**
- * @brief Performs a one-point crossover on two parent matrices.
- * 
- * This function takes two parent matrices and performs a one-point crossover
- * to produce offspring. The crossover point is chosen randomly, and the 
- * elements of the matrices are swapped at that point to create new offspring.
- * 
- * @param parent1 A pointer to the first parent matrix.
- * @param parent2 A pointer to the second parent matrix.
+ * @brief Returns a random integer in [0, bound).
+ *
+ * Uses the high 32 bits of the stream scaled by bound (multiply-shift), which avoids
+ * a division; the bias is below bound / 2^32.
+ *
+ * @param rng The stream to advance.
+ * @param bound The exclusive upper bound, greater than 0.
+ * @return A random integer in [0, bound).
  */
-int onePointCrossover(int** parent1, int** parent2);
+inline int randomBelow(Rng &rng, int bound){
+    return (int)(((nextRandom(rng) >> 32) * (uint64_t)bound) >> 32);
+}
 
+/**
+ * @brief Creates the random stream with the given id for a run seed.
+ *
+ * The seed and stream id are hashed into the initial state, so streams created for
+ * different ids (threads, individuals, ...) of the same seed are independent, and the
+ * same (seed, stream) pair always yields the same sequence.
+ *
+ * @param seed The run seed (see --seed).
+ * @param stream The stream id.
+ * @return The seeded stream.
+ */
+Rng makeRng(uint64_t seed, uint64_t stream);
 
 /**
- * @brief Performs a two-point crossover on two parent matrices.
+ * @brief Returns a seed taken from the high-resolution clock, for runs without --seed.
  *
- * This function takes two parent matrices and performs a two-point crossover
- * to generate offspring. The crossover points are chosen randomly, and the
- * segments between these points are swapped between the two parents.
+ * @return A clock-derived seed.
+ */
+uint64_t getClockSeed();
+
+/**
+ * @brief Returns the number of global operator new calls made so far.
+ *
+ * Counting is compiled in with -DEVOL_PUZZLE_COUNT_ALLOCATIONS, which replaces the
+ * global operator new/delete with counting versions; evolve then reports the
+ * allocations made by each generation.
  *
- * @param parent1 A pointer to the first parent matrix.
- * @param parent2 A pointer to the second parent matrix.
+ * @return The allocation count, or -1 if counting was not compiled in.
  */
-pair<int, int>  twoPointCrossover(int** parent1, int** parent2);
+long long getAllocationCount();
 
 /**
- * @brief Evolves a population of solutions over a specified number of generations.
+ * @brief Runs task(0..task_count-1) on the OpenMP threads with work stealing.
  *
- * This function performs genetic algorithm operations such as crossover and mutation
- * on a population of solutions. It evaluates the fitness of the population after each
- * generation and tracks the minimum edge mismatch count.
+ * Every thread starts with a contiguous block of task indices; a thread that runs out
+ * steals the back half of another thread's remaining block with a single CAS, so
+ * tasks of uneven cost stay balanced across cores. Runs serially without OpenMP.
  *
- * @param population_arr A pointer to a 3D array representing the population of solutions.
- * @param NUM_OF_GENERATIONS The number of generations to evolve the population.
- * @param POPULATION_SIZE The size of the population.
+ * @param task_count The number of tasks.
+ * @param task The task body, called with the task index and context.
+ * @param context Passed through to every task.
+ * @return The number of successful steals.
  */
-void evolve(int*** population_arr, int NUM_OF_GENERATIONS, const int POPULATION_SIZE, const unordered_map<string, int> &duplicatesMap, const unordered_map<string, string> &map_of_tiles,pair<mt19937, uniform_int_distribution<int>> random, bool print_flag);
+int runWorkStealing(int task_count, void (*task)(int task_index, void* context), void* context);
 
 /**
- * @brief Mutates a population of puzzles by performing random rotations and swaps.
- * 
- * This function iterates over each puzzle in the population and performs a series of 
- * random rotations and swaps on the tiles within each puzzle. The number of rotations 
- * and swaps is determined randomly for each puzzle.
- * 
- * @param population_arr A 3D array representing the population of puzzles.
- * @param POPULATION_SIZE The number of puzzles in the population.
- * 
- * The function uses the Mersenne Twister random number generator to ensure high-quality 
- * randomness. For each puzzle, it generates a random number of iterations and performs 
- * the following operations:
- * - Rotates a randomly selected tile to the left by one index.
- * - Swaps tiles within the puzzle.
+ * @brief Returns whether the CPU running the program supports AVX2 (checked via CPUID once).
  */
-void mutate(int*** offspring_arr, const int POPULATION_SIZE, pair<mt19937, uniform_int_distribution<int>> random, int mutation_rate);
+bool hasAVX2();
 
 /**
- * @brief Performs crossover operation on a population array.
- * 
- * This function iterates through the population array in pairs and applies
- * a two-point crossover operation on each pair. The crossover is performed
- * only if there is a valid pair (i.e., the second individual in the pair exists).
- * 
- * @param population_arr A pointer to the population array, where each individual
- *                       is represented as a pointer to an array of integers.
- * @param POPULATION_SIZE The size of the population array.
+ * @brief Returns the default annealing settings: geometric cooling, no reheats, one replica.
  */
-void crossover(int*** population_arr, const int POPULATION_SIZE, const vector<int> &parent_indexes_vec, int*** offspring_arr, const unordered_map<string, int> &duplicatesMap, const unordered_map<string,string> &map_of_tiles, int min_edge_mismatch_count, pair<mt19937, uniform_int_distribution<int>> random);
+AnnealingSettings makeAnnealingSettings();
 
 /**
- * @brief Evaluates the fitness of a population of puzzle solutions.
+ * @brief Returns the temperature of a cooling schedule at some point of a run.
  *
- * This function iterates through a population of puzzle solutions and calculates
- * the edge mismatch count for each solution. It returns the minimum edge mismatch
- * count found in the population, which represents the best fitness score.
- *
- * @param population_arr A 3D array representing the population of puzzle solutions.
- * @param POPULATION_SIZE The number of puzzle solutions in the population.
- * @param min_edge_mismatch_count The initial minimum edge mismatch count to compare against.
- * @return The minimum edge mismatch count found in the population.
+ * @param schedule The cooling schedule.
+ * @param start_temperature The temperature at progress 0.
+ * @param end_temperature The temperature at progress 1.
+ * @param progress How far the run is, in [0, 1].
+ * @return The temperature.
  */
-vector<pair<int, int>> evaluateFitness(int*** population_arr, const int POPULATION_SIZE);
+double coolingTemperature(CoolingSchedule schedule, double start_temperature, double end_temperature, double progress);
 
 /**
- * @brief Selects the indices of the parent puzzles and the worst puzzles from the population.
- * 
- * This function selects the top-ranking puzzles as parents and the bottom-ranking puzzles as the worst
- * based on their fitness values. The selection is done using a sorted index vector.
- * 
- * @param population_arr A 3D array representing the population of puzzles.
- * @param POPULATION_SIZE The total size of the population.
- * @param sorted_index_by_fitness_vec A vector of pairs where each pair contains an index and its corresponding fitness value, sorted by fitness.
- * @param ratio_adjusted_pop_size The number of top-ranking puzzles to select as parents and the number of bottom-ranking puzzles to select as worst.
- * 
- * @return A pair of vectors:
- *         - The first vector contains the indices of the selected parent puzzles.
- *         - The second vector contains the indices of the selected worst puzzles.
+ * @brief Decides whether an engine hands its best individual to completeExact this generation.
+ *
+ * True once the best edge mismatch count is at most EXACT_COMPLETION_THRESHOLD, in the
+ * generation it improves and then every EXACT_COMPLETION_INTERVAL generations without
+ * improvement, when a different individual may hold the best count.
+ *
+ * @param best_edge_mismatch The edge mismatch count of the current best individual.
+ * @param min_edge_mismatch_count The lowest edge mismatch count of earlier generations.
+ * @param stagnated_generation_count The generations since the last improvement.
+ * @param completion_node_limit The node budget of the completion, 0 when it is disabled.
  */
-pair<vector<int>, vector<int>> selectParentsAndWorst(int*** population_arr, const int POPULATION_SIZE, const vector<pair<int, int>> &sorted_index_by_fitness_vec, const int ratratio_adjusted_pop_sizeio);
+inline bool shouldCompleteExact(int best_edge_mismatch, int min_edge_mismatch_count, int stagnated_generation_count, long long completion_node_limit){
+    return completion_node_limit > 0 && best_edge_mismatch > 0 && best_edge_mismatch <= EXACT_COMPLETION_THRESHOLD
+        && (best_edge_mismatch < min_edge_mismatch_count || stagnated_generation_count % EXACT_COMPLETION_INTERVAL == 0);
+}
 
 /**
- * @brief Replaces the worst individuals in the population with new offspring.
+ * @brief Reads the shape of a puzzle input file without parsing its tiles.
+ *
+ * Used to pick the EvolPuzzle instantiation for the file (see dispatchGeometry)
+ * before EvolPuzzle::readInput parses it.
  *
- * This function takes the worst individuals in the population, as indicated by their indices,
- * and replaces them with the corresponding offspring. The replacement is done in-place.
+ * @param filename The path to the input file.
+ * @param width Receives the number of tiles on each line.
+ * @param height Receives the number of non-empty lines.
+ * @param motif_count Receives the highest motif in the file plus one.
  *
- * @param population_arr A pointer to the 3D array representing the current population.
- * @param POPULATION_SIZE The size of the population.
- * @param worst_index_vec A vector containing the indices of the worst individuals in the population.
- * @param offspring_arr A pointer to the 3D array representing the new offspring.
+ * @throws runtime_error If the file cannot be opened, its lines differ in length or a
+ *         tile holds a character that is not a motif.
  */
-void selectSurvivorsAndReplace(int*** population_arr, const int POPULATION_SIZE, const vector<int> &worst_index_vec, int*** offspring_arr);
+void readInputShape(const string &filename, int &width, int &height, int &motif_count);
 
 /**
- * @brief Copies the contents of one puzzle to another.
- * 
- * This function copies the contents of the source puzzle to the destination puzzle.
- * Both puzzles are assumed to be 2D arrays with dimensions TILES_IN_PUZZLE_COUNT x TILE_SIZE.
- * 
- * @param source_puzzle A pointer to the source puzzle (2D array) to copy from.
- * @param dest_puzzle A pointer to the destination puzzle (2D array) to copy to.
+ * @brief The command-line options and prompted sizes of a run.
+ *
+ * Filled by parseRunOptions and the prompts of main.
  */
-void copyPuzzle(int** source_puzzle, int** copy_puzzle);
+struct RunOptions {
+    bool print_flag = false;
+    uint64_t seed = getClockSeed();
+    int island_count = 1;
+    int process_count = 1;
+    MigrationTopology topology = RING_TOPOLOGY;
+    int migration_interval = 50;
+    int migrant_count = 2;
+    bool steady_state_flag = false;
+    bool exact_flag = false;
+    bool anneal_flag = false;
+    AnnealingSettings annealing_settings = makeAnnealingSettings();
+    long long exact_node_limit = EXACT_NODE_LIMIT;
+    long long completion_node_limit = 0;
+    SelectionMethod selection_method = TRUNCATION_SELECTION;
+    LocalSearchMethod local_search_method = NO_LOCAL_SEARCH;
+    InitializationMethod initialization_method = RANDOM_INITIALIZATION;
+    int POPULATION_SIZE = 0;
+    int NUM_OF_GENERATIONS = 0;
+};
 
 /**
- * @brief Copies the contents of one tile to another.
- * 
- * This function copies the contents of the source tile array to the destination tile array.
- * It assumes that both arrays have a size of TILE_SIZE.
- * 
- * @param source_tile Pointer to the source tile array.
- * @param dest_tile Pointer to the destination tile array.
+ * @brief Parses the command-line options of main (documented in main.cpp) into `options`.
+ *
+ * Unknown arguments are skipped; an unknown method name keeps the default and is reported.
+ *
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @param options Receives the parsed options, the other fields keep their values.
  */
-void copyTile(int* source_tile, int* dest_tile);
+void parseRunOptions(int argc, char** argv, RunOptions &options);
 
 /**
- * @brief Copies a source puzzle into each element of a destination population.
- * 
- * This function iterates over a population array and copies the source puzzle 
- * into each individual in the population. The population is represented as a 
- * 3D array where each individual is a 2D array (puzzle).
- * 
- * @param destination_population A 3D array representing the population where 
- *        each individual is a 2D array (puzzle) to be filled with the source puzzle.
- * @param POPULATION_SIZE The number of individuals in the population.
- * @param source_puzzle A 2D array representing the puzzle to be copied into 
- *        each individual of the population.
+ * @brief The solver for puzzles of WIDTH x HEIGHT tiles whose motifs are below MOTIFS.
+ *
+ * The geometry is a template parameter, so every loop over rows, columns and edges
+ * has constant bounds and countEdgeMismatch and the operators unroll for each size.
+ * evol-puzzle.cpp instantiates the solver for every geometry of
+ * EVOL_PUZZLE_FOR_EACH_SIZE, each with the SMALL_MOTIF_COUNT and MAX_MOTIF_COUNT
+ * motif capacities, and dispatchGeometry picks the instantiation matching an input file.
  */
-void writePuzzleIntoPopulation(int***, const int POPULATION_SIZE, int**);
+template<int WIDTH, int HEIGHT, int MOTIFS>
+struct EvolPuzzle {
+    /**
+     * @brief The number of tiles in each row of the puzzle.
+     */
+    static constexpr int PUZZLE_WIDTH = WIDTH;
+
+    /**
+     * @brief The number of rows of the puzzle.
+     */
+    static constexpr int PUZZLE_HEIGHT = HEIGHT;
+
+    /**
+     * @brief The number of tiles in the puzzle.
+     * 
+     * This constant defines the total count of tiles present in the puzzle.
+     * It is used throughout the code to ensure consistency when referring to
+     * the number of tiles in the puzzle.
+     */
+    static constexpr int TILES_IN_PUZZLE_COUNT = PUZZLE_WIDTH * PUZZLE_HEIGHT;
+
+    /**
+     * @brief The number of inner edges of the puzzle, i.e. the worst possible edge mismatch count.
+     * 
+     * Each row has PUZZLE_WIDTH - 1 horizontal neighbours and each column has
+     * PUZZLE_HEIGHT - 1 vertical ones, 112 for the 8x8 puzzle.
+     */
+    static constexpr int MAX_EDGE_MISMATCH_COUNT = PUZZLE_HEIGHT * (PUZZLE_WIDTH - 1) + PUZZLE_WIDTH * (PUZZLE_HEIGHT - 1);
+
+    /**
+     * @brief The number of distinct motifs an edge can carry (0 to MOTIF_COUNT - 1).
+     * 
+     * This is a capacity: an input with fewer motifs leaves the upper ones unused, so
+     * one instantiation serves every motif count up to MOTIF_COUNT.
+     */
+    static constexpr int MOTIF_COUNT = MOTIFS;
+
+    /**
+     * @brief The number of distinct four-motif tiles, MOTIF_COUNT^TILE_SIZE (4096 for SMALL_MOTIF_COUNT).
+     */
+    static constexpr int MOTIF_COMBINATION_COUNT = MOTIF_COUNT * MOTIF_COUNT * MOTIF_COUNT * MOTIF_COUNT;
+
+    static_assert(PUZZLE_WIDTH >= 2 && PUZZLE_HEIGHT >= 2, "the puzzle needs at least two rows and two columns");
+    static_assert(MOTIF_COUNT >= 2 && MOTIF_COUNT <= MAX_MOTIF_COUNT, "motifs are written as one character, 0-9 then a-z");
+
+    /**
+     * @brief The number of bits used to store one edge motif in a packed tile.
+     * 
+     * Motifs are in the range 0 to MOTIF_COUNT - 1, so 3 bits per edge are enough for SMALL_MOTIF_COUNT motifs.
+     */
+    static constexpr int BITS_PER_EDGE = bitWidth(MOTIF_COUNT - 1);
+
+    /**
+     * @brief Mask selecting a single edge motif once shifted down to bit 0.
+     */
+    static constexpr int EDGE_MASK = (1 << BITS_PER_EDGE) - 1;
+
+    /**
+     * @brief Mask selecting the TILE_SIZE * BITS_PER_EDGE bits used by a packed tile.
+     */
+    static constexpr int TILE_MASK = (1 << (TILE_SIZE * BITS_PER_EDGE)) - 1;
+
+    /**
+     * @brief A single tile packed into 16 bits, or 32 when the motifs need more than 4 bits.
+     * 
+     * Edge k ([top, right, bottom, left]) is stored in bits [3k, 3k + 3) with up to 8 motifs,
+     * so a whole tile takes 12 bits and a 64-tile puzzle fits in two cache lines.
+     */
+    typedef typename conditional<TILE_SIZE * BITS_PER_EDGE <= 16, uint16_t, uint32_t>::type Tile;
+
+    /**
+     * @brief One position of a puzzle: which input tile is placed there and how it is rotated.
+     * 
+     * The tile index (0..TILES_IN_PUZZLE_COUNT - 1) is stored in the high bits and the
+     * rotation (0..3, the number of left rotations applied to the input tile) in the
+     * low ROTATION_BITS bits. Since every gene names a distinct input tile, a puzzle
+     * is a permutation of tile indices and crossover or mutation only move bytes.
+     * Puzzles of up to 64 tiles use one byte per gene, larger ones two.
+     */
+    typedef typename conditional<TILES_IN_PUZZLE_COUNT <= 64, uint8_t, uint16_t>::type Gene;
+
+    static_assert(TILES_IN_PUZZLE_COUNT << ROTATION_BITS <= 1 << (8 * sizeof(Gene)), "a gene must hold every tile index and rotation");
+
+    /**
+     * @brief A puzzle, made of TILES_IN_PUZZLE_COUNT contiguous genes.
+     * 
+     * Positions are laid out row by row, so `puzzle[i]` is the gene at position i.
+     */
+    typedef Gene* Puzzle;
+
+    /**
+     * @brief Returns the motif on the given edge of a packed tile.
+     * 
+     * @param tile The packed tile.
+     * @param edge The edge to read (TOP, RIGHT, BOTTOM or LEFT).
+     * @return The motif on that edge.
+     */
+    static int getEdge(Tile tile, int edge){
+        return (tile >> (edge * BITS_PER_EDGE)) & EDGE_MASK;
+    }
+
+    /**
+     * @brief Packs TILE_SIZE motifs in [top, right, bottom, left] order into a tile.
+     * 
+     * @param edges The motifs of the tile.
+     * @return The packed tile.
+     */
+    static Tile packTile(const int edges[]){
+        Tile tile = 0;
+        for (int i = 0; i < TILE_SIZE; i++){
+            tile |= edges[i] << (i * BITS_PER_EDGE);
+        }
+        return tile;
+    }
+
+    /**
+     * @brief Rotates a packed tile so that each edge takes the motif of the next one.
+     * 
+     * This is the packed equivalent of shifting [top, right, bottom, left] one index
+     * to the left: a TILE_SIZE * BITS_PER_EDGE-bit rotate right by BITS_PER_EDGE.
+     * 
+     * @param tile The packed tile.
+     * @return The rotated tile.
+     */
+    static Tile rotateTile(Tile tile){
+        return (Tile)(((tile >> BITS_PER_EDGE) | (tile << ((TILE_SIZE - 1) * BITS_PER_EDGE))) & TILE_MASK);
+    }
+
+    /**
+     * @brief Builds a gene from a tile index and a rotation.
+     * 
+     * @param tile_index The index of the tile in the input puzzle.
+     * @param rotation The number of left rotations applied to the tile (0..3).
+     * @return The gene.
+     */
+    static Gene makeGene(int tile_index, int rotation){
+        return (Gene)((tile_index << ROTATION_BITS) | rotation);
+    }
+
+    /**
+     * @brief Returns the index of the input tile placed by a gene.
+     */
+    static int getGeneTile(Gene gene){
+        return gene >> ROTATION_BITS;
+    }
+
+    /**
+     * @brief Returns the rotation of the tile placed by a gene.
+     */
+    static int getGeneRotation(Gene gene){
+        return gene & ROTATION_MASK;
+    }
+
+    /**
+     * @brief Precomputed edges of every input tile in every rotation.
+     * 
+     * Built once from the input puzzle by buildEdgeTable. `edges[t][r][e]` is the motif
+     * on edge e of input tile t after r left rotations, and `tiles[t][r]` is the same
+     * rotated tile in packed form, used to convert a puzzle back to the four-digit format.
+     * Since a gene is `t << 2 | r`, the four edges of a gene are the 4 bytes at
+     * `edges` + 4 * gene, which the vectorized kernels gather as one 32-bit value.
+     */
+    struct EdgeTable {
+        alignas(CACHE_LINE_SIZE) uint8_t edges[TILES_IN_PUZZLE_COUNT][TILE_SIZE][TILE_SIZE];
+        Tile tiles[TILES_IN_PUZZLE_COUNT][TILE_SIZE];
+    };
+
+    /**
+     * @brief Returns the motif on the given edge of the tile placed by a gene.
+     * 
+     * @param edge_table The edge table built from the input puzzle.
+     * @param gene The gene.
+     * @param edge The edge to read (TOP, RIGHT, BOTTOM or LEFT).
+     * @return The motif on that edge.
+     */
+    static int getGeneEdge(const EdgeTable &edge_table, Gene gene, int edge){
+        return edge_table.edges[getGeneTile(gene)][getGeneRotation(gene)][edge];
+    }
+
+    /**
+     * @brief Returns the packed tile placed by a gene, with its rotation applied.
+     */
+    static Tile geneToTile(const EdgeTable &edge_table, Gene gene){
+        return edge_table.tiles[getGeneTile(gene)][getGeneRotation(gene)];
+    }
+
+    /**
+     * @brief A canonical tile id or tile count, wide enough for every tile of the puzzle.
+     */
+    typedef typename conditional<TILES_IN_PUZZLE_COUNT < 128, int8_t, int16_t>::type TileClassId;
+
+    /**
+     * @brief Canonical ids of the distinct input tiles, up to rotation.
+     * 
+     * Two input tiles that are rotations of each other are the same tile as far as the
+     * puzzle is concerned. `canonical_id` is indexed directly by the base-MOTIF_COUNT encoding of
+     * a tile (see encodeTileIndex) and maps every input tile, in every rotation, to a
+     * small integer in [0, class_count); every other encoding maps to -1.
+     * `multiplicity[c]` is the number of input tiles with canonical id c, and
+     * `tile_class[t]` is the canonical id of input tile t.
+     */
+    struct TileClassTable {
+        TileClassId canonical_id[MOTIF_COMBINATION_COUNT];
+        TileClassId multiplicity[TILES_IN_PUZZLE_COUNT];
+        TileClassId tile_class[TILES_IN_PUZZLE_COUNT];
+        int class_count;
+    };
+
+    /**
+     * @brief Returns the base-MOTIF_COUNT encoding of a packed tile, in [0, MOTIF_COMBINATION_COUNT).
+     * 
+     * @param tile The packed tile.
+     * @return ((top * MOTIF_COUNT + right) * MOTIF_COUNT + bottom) * MOTIF_COUNT + left.
+     */
+    static int encodeTileIndex(Tile tile){
+        int index = 0;
+        for (int i = 0; i < TILE_SIZE; i++){
+            index = index * MOTIF_COUNT + getEdge(tile, i);
+        }
+        return index;
+    }
+
+    /**
+     * @brief The genes of every input tile in every rotation, grouped by their top and left motifs.
+     * 
+     * Built once by buildCandidateIndex. The genes whose rotated tile has top motif t and
+     * left motif l are `genes[start[t * MOTIF_COUNT + l]]` up to, but not including,
+     * `genes[start[t * MOTIF_COUNT + l + 1]]`, so the tiles that fit under a placed tile and
+     * right of another one are found without scanning the whole input.
+     */
+    struct CandidateIndex {
+        int start[MOTIF_COUNT * MOTIF_COUNT + 1];
+        Gene genes[TILES_IN_PUZZLE_COUNT * TILE_SIZE];
+    };
+
+    /**
+     * @brief A population of puzzles stored in one contiguous, cache-line-aligned buffer.
+     * 
+     * Individual i starts at `data + i * stride`. The stride is the size of a puzzle
+     * rounded up to a multiple of CACHE_LINE_SIZE, so every individual starts on its
+     * own cache line and the whole population is a single heap allocation.
+     */
+    struct Population {
+        int size;     // number of individuals
+        int stride;   // number of genes between the start of two consecutive individuals
+        Gene* data;   // aligned start of the first individual
+        char* raw;    // underlying allocation, released by freePopulation
+        int* fitness; // cached edge mismatch count of each individual, kept exact by the operators
+        bool* dirty;  // set when an individual was rebuilt and its fitness must be rescored
+
+        Puzzle operator[](int index) const {
+            return data + (size_t)index * stride;
+        }
+    };
+
+    /**
+     * @brief The individuals of a population bucketed by their cached edge mismatch count.
+     *
+     * Fitness is a small integer in [0, MAX_EDGE_MISMATCH_COUNT], so one bucket per value
+     * gives O(1) insertion and removal (swap with the bucket's last entry) and the worst
+     * and best individuals in O(1) amortized, without sorting. The steady-state engine
+     * keeps it up to date as every child replaces the worst individual.
+     */
+    struct FitnessBuckets {
+        vector<int> bucket[MAX_EDGE_MISMATCH_COUNT + 1]; // the individuals with each edge mismatch count
+        vector<int> position; // index of each individual within its bucket
+        int worst;            // no bucket above this one is occupied
+        int best;             // no bucket below this one is occupied
+    };
+
+    /**
+     * @brief A genome with its edge mismatch count, as passed between islands.
+     */
+    struct Migrant {
+        Gene genes[TILES_IN_PUZZLE_COUNT];
+        int fitness;
+    };
+
+    /**
+     * @brief A lock-free bounded single-producer single-consumer queue of migrants.
+     *
+     * There is one queue per ordered pair of islands, so each queue has exactly one
+     * sending and one receiving thread and two atomic counters are enough. A full queue
+     * drops the migrant instead of waiting, so islands never block each other. The
+     * counters sit on their own cache lines to keep the two threads from false sharing.
+     */
+    struct MigrationQueue {
+        Migrant slots[MIGRATION_QUEUE_CAPACITY];
+        char head_padding[CACHE_LINE_SIZE];
+        atomic<unsigned> head; // next slot to read, advanced by the receiving island
+        char tail_padding[CACHE_LINE_SIZE];
+        atomic<unsigned> tail; // next slot to write, advanced by the sending island
+    };
+
+    /**
+     * @brief State shared by all islands of an island-model run.
+     */
+    struct IslandGroup {
+        int island_count;
+        MigrationTopology topology;
+        int migration_interval;    // generations between two migrations
+        int migrant_count;         // best individuals sent per destination per migration
+        MigrationQueue* queues;    // queues[from * island_count + to]
+        atomic<int>* island_state; // IslandState of each island, null when islands are threads
+        atomic<bool> solved;       // set by the first island to reach 0 edge mismatches
+    };
+
+    /**
+     * @brief Registration and result of one island process, kept in shared memory.
+     *
+     * Islands discover their peers through these slots and the group's island_state.
+     */
+    struct ProcessSlot {
+        atomic<int> pid;   // process id, 0 until the island registers
+        Migrant best;      // best puzzle and its edge mismatch count, written on exit
+        int restart_count; // stagnation restarts, written on exit
+    };
+
+    /**
+     * @brief One island of an island-model run, passed to evolve.
+     */
+    struct Island {
+        IslandGroup* group;
+        int index;
+        Puzzle best_puzzle;      // filled by evolve with the island's best puzzle
+        int best_edge_mismatch;  // filled by evolve with the island's lowest edge mismatch count
+        int restart_count;       // filled by evolve with the number of stagnation restarts
+    };
+
+    /**
+     * @brief Returns a random puzzle position in [0, TILES_IN_PUZZLE_COUNT).
+     *
+     * @param rng The stream to advance.
+     * @return A random position.
+     */
+    static int randomTileIndex(Rng &rng){
+        return randomBelow(rng, TILES_IN_PUZZLE_COUNT);
+    }
+
+    /**
+     * @brief Rotates the edges of the given tile to the left by one index.
+     * 
+     * Each edge takes the motif of the next one and the top motif moves to the left
+     * edge. On a packed tile this is a single bit-rotate (see rotateTile).
+     * 
+     * @param tile The tile to be rotated in place.
+     */
+    static void rotateToLeftByOneIndex(Tile &tile);
+
+    /**
+     * @brief Rotates the tile placed by a gene to the left by one index.
+     * 
+     * This is the genome equivalent of rotateToLeftByOneIndex: the tile index is kept
+     * and the rotation is incremented modulo TILE_SIZE.
+     * 
+     * @param gene The gene to be rotated in place.
+     */
+    static void rotateGene(Gene &gene);
+
+    /**
+     * @brief Converts a packed tile to a string.
+     * 
+     * This function concatenates the TILE_SIZE motifs of the tile into a single
+     * string, e.g. "2310".
+     * 
+     * @param tile The packed tile.
+     * @return A string representation of the tile.
+     */
+    static string convertTileToString(Tile tile);
+
+    /**
+     * @brief Builds the canonical id table of the input tiles.
+     *
+     * This function assigns a canonical id to every distinct input tile (up to rotation),
+     * records it for all four rotations in the direct-indexed table, and counts how many
+     * input tiles share each id. It replaces the string-keyed maps previously built by
+     * buildMapOfTiles and recordDuplicateTiles.
+     *
+     * @param input_tiles The TILES_IN_PUZZLE_COUNT packed tiles read by readInput.
+     * @return The canonical id table.
+     */
+    static TileClassTable buildTileClassTable(const Tile* input_tiles);
+
+    /**
+     * @brief Checks that a four-digit puzzle uses exactly the input tiles.
+     *
+     * Each tile is looked up in the canonical id table, in whatever rotation it is
+     * placed, and counted in a stack-allocated array. The puzzle is valid if every
+     * canonical id appears exactly as many times as in the input.
+     *
+     * @param tiles TILES_IN_PUZZLE_COUNT packed tiles, e.g. from decodePuzzle.
+     * @param tile_class_table The canonical id table built from the input puzzle.
+     * @return true if the tiles are a rearrangement of the input tiles, false otherwise.
+     */
+    static bool hasInputTileCounts(const Tile* tiles, const TileClassTable &tile_class_table);
+
+    /**
+     * @brief Swaps two random tiles in a 2D array.
+     *
+     * This function selects two distinct random indices within the range of the puzzle tiles
+     * and swaps the tiles at these indices.
+     *
+     * @param arr The puzzle whose tiles are swapped.
+     * @param rng The random stream used to pick the indices.
+     */
+    static void swapTile(Puzzle arr, Rng &rng);
+
+    /**
+     * @brief Counts the edge mismatches between a position and its (up to 4) neighbours.
+     *
+     * @param puzzle The puzzle.
+     * @param index The position whose edges are checked.
+     * @param edge_table The edge table built from the input puzzle.
+     * @return The number of mismatching edges around that position.
+     */
+    static int countLocalEdgeMismatch(const Gene* puzzle, int index, const EdgeTable &edge_table);
+
+    /**
+     * @brief Swaps the tiles at two positions and returns the resulting change in edge mismatch.
+     *
+     * Only the edges around the two positions can change, so the delta costs O(1)
+     * instead of a full countEdgeMismatch. Adjacent positions are handled.
+     *
+     * @param puzzle The puzzle to modify.
+     * @param first_index The first position.
+     * @param second_index The second position.
+     * @param edge_table The edge table built from the input puzzle.
+     * @return The edge mismatch count after the swap minus the count before it.
+     */
+    static int swapTileDelta(Puzzle puzzle, int first_index, int second_index, const EdgeTable &edge_table);
+
+    /**
+     * @brief Rotates the tile at a position and returns the resulting change in edge mismatch.
+     *
+     * @param puzzle The puzzle to modify.
+     * @param index The position of the tile to rotate (see rotateGene).
+     * @param edge_table The edge table built from the input puzzle.
+     * @return The edge mismatch count after the rotation minus the count before it.
+     */
+    static int rotateGeneDelta(Puzzle puzzle, int index, const EdgeTable &edge_table);
+
+    /**
+     * @brief Turns the tile at a position to the rotation that best matches its neighbours.
+     *
+     * All four rotations are scored straight from the edge table; on a tie the current
+     * rotation is kept, so the edge mismatch count never goes up.
+     *
+     * @param puzzle The puzzle to modify.
+     * @param index The position of the tile to turn.
+     * @param edge_table The edge table built from the input puzzle.
+     * @return The edge mismatch count after the change minus the count before it.
+     */
+    static int bestRotationDelta(Puzzle puzzle, int index, const EdgeTable &edge_table);
+
+    /**
+     * @brief Gives every tile of a puzzle its best rotation for the current placement.
+     *
+     * Checks every position with bestRotationDelta and rechecks the neighbours of every
+     * tile it turns, until a fixpoint where no single tile can be turned to a better
+     * rotation. Tile positions are left alone. mutate ends every offspring with it.
+     *
+     * @param puzzle The puzzle to repair in place.
+     * @param edge_table The edge table built from the input puzzle.
+     * @return The edge mismatch count after the repair minus the count before it, never positive.
+     */
+    static int repairRotations(Puzzle puzzle, const EdgeTable &edge_table);
+
+    /**
+     * @brief Reads a puzzle input from a file and stores it as packed tiles.
+     * 
+     * This function reads the contents of the specified file, parses each four-digit number
+     * into a packed tile, and stores the result in the provided array `puzzle`.
+     * 
+     * @param filename The path to the input file containing the puzzle data.
+     * @param puzzle An array of TILES_IN_PUZZLE_COUNT tiles where the parsed puzzle data will be stored.
+     * 
+     * @note The input file should contain numbers arranged in a specific format that can be parsed
+     *       into a 2D array of integers.
+     * @note The dimensions of the `puzzle` array should match the expected dimensions defined by
+     *       `TILES_IN_PUZZLE_COUNT` and `TILE_SIZE`.
+     * 
+     * @throws runtime_error If the file cannot be opened.
+     */
+    static void readInput(string, Tile* puzzle);
+
+    /**
+     * @brief Builds the edge table of the input tiles.
+     * 
+     * This function computes, once, the four rotations of every input tile and the
+     * motif on each of their edges, so the genetic operators never have to rotate
+     * tiles again.
+     * 
+     * @param input_tiles The TILES_IN_PUZZLE_COUNT packed tiles read by readInput.
+     * @return The edge table.
+     */
+    static EdgeTable buildEdgeTable(const Tile* input_tiles);
+
+    /**
+     * @brief Writes the input arrangement into a puzzle.
+     * 
+     * Position i receives input tile i with no rotation.
+     * 
+     * @param puzzle The puzzle to initialize.
+     */
+    static void writeInputOrder(Puzzle puzzle);
+
+    /**
+     * @brief Converts a puzzle back to packed tiles in the four-digit format.
+     * 
+     * @param puzzle The puzzle to convert.
+     * @param edge_table The edge table built from the input puzzle.
+     * @param tiles An array of TILES_IN_PUZZLE_COUNT tiles receiving the rotated tiles.
+     */
+    static void decodePuzzle(const Gene* puzzle, const EdgeTable &edge_table, Tile* tiles);
+
+    /**
+     * @brief Allocates memory for a population of individuals.
+     * 
+     * This function allocates a single contiguous buffer holding every individual of
+     * the population. Each individual starts on a cache line boundary and consecutive
+     * individuals are `stride` genes apart.
+     * 
+     * @param population_size The number of individuals in the population.
+     * @return The allocated population.
+     */
+    static Population allocatePopulation(int population_size);
+
+    /**
+     * @brief Allocates memory for a puzzle.
+     * 
+     * This function allocates TILES_IN_PUZZLE_COUNT contiguous genes in a single allocation.
+     * 
+     * @return Puzzle A pointer to the first gene of the allocated puzzle.
+     */
+    static Puzzle allocatePuzzle();
+
+    /**
+     * @brief Frees the memory allocated for a puzzle.
+     * 
+     * @param puzzle The puzzle returned by allocatePuzzle.
+     */
+    static void freePuzzle(Puzzle puzzle);
+
+    /**
+     * @brief Frees the memory allocated for a population of puzzle solutions.
+     *
+     * This function releases the single buffer backing the population and resets
+     * the population to an empty state.
+     *
+     * @param population The population returned by allocatePopulation.
+     */
+    static void freePopulation(Population &population);
+
+    /**
+     * @brief Generates an initial population for the puzzle solver.
+     *
+     * This function initializes a population array with a given size, where each 
+     * individual in the population is a variation of the initial puzzle configuration.
+     *
+     * Individual 0 is the initial puzzle itself. When built with OpenMP, every thread
+     * fills a contiguous block of the remaining individuals by repeatedly shuffling and
+     * rotating its own copy of the initial puzzle with its own random stream, so the
+     * result only depends on the caller's stream and the number of threads.
+     *
+     * @param population_arr The population to store the generated individuals in.
+     * @param arr The initial puzzle configuration.
+     * @param population_size The number of individuals in the population.
+     * @param rng The random stream used to shuffle and rotate the tiles.
+     */
+    static void generatePopulation(Population &population_arr, Puzzle puzzle, int population_size, Rng &rng);
+
+    /**
+     * @brief Groups the genes of every input tile in every rotation by their top and left motifs.
+     *
+     * @param edge_table The edge table built from the input puzzle.
+     * @return The candidate index.
+     */
+    static CandidateIndex buildCandidateIndex(const EdgeTable &edge_table);
+
+    /**
+     * @brief Builds a puzzle with a randomized greedy (GRASP) construction.
+     *
+     * Positions are filled in row order. Each one takes a random unused tile, in a
+     * rotation that matches both the tile above and the tile on the left when one exists,
+     * otherwise one of the two, otherwise any unused tile in any rotation. The candidates
+     * come from the candidate index, so a position never scans the whole input.
+     *
+     * @param puzzle Receives the puzzle.
+     * @param candidate_index The candidate index built from the input puzzle.
+     * @param edge_table The edge table built from the input puzzle.
+     * @param rng The random stream used to pick among the candidates.
+     */
+    static void greedyConstruct(Puzzle puzzle, const CandidateIndex &candidate_index, const EdgeTable &edge_table, Rng &rng);
+
+    /**
+     * @brief Generates an initial population with greedyConstruct.
+     *
+     * Like generatePopulation, every thread fills a contiguous block of the population
+     * with its own random stream, so the result only depends on the caller's stream and
+     * the number of threads. Every individual is marked dirty.
+     *
+     * @param population_arr The population to store the generated individuals in.
+     * @param population_size The number of individuals in the population.
+     * @param edge_table The edge table built from the input puzzle.
+     * @param rng The random stream the per-thread streams are derived from.
+     */
+    static void generateGreedyPopulation(Population &population_arr, int population_size, const EdgeTable &edge_table, Rng &rng);
+
+    /**
+     * @brief Generates the first population of a run with the given method.
+     *
+     * @param population_arr The population to store the generated individuals in.
+     * @param puzzle The input puzzle, used by RANDOM_INITIALIZATION.
+     * @param population_size The number of individuals in the population.
+     * @param edge_table The edge table built from the input puzzle.
+     * @param rng The random stream of the run.
+     * @param initialization_method generatePopulation or generateGreedyPopulation.
+     */
+    static void initializePopulation(Population &population_arr, Puzzle puzzle, int population_size, const EdgeTable &edge_table, Rng &rng, InitializationMethod initialization_method);
+
+    /**
+     * @brief Signature shared by the edge mismatch kernels.
+     */
+    typedef int (*EdgeMismatchKernel)(const Gene* puzzle, const EdgeTable &edge_table);
+
+    /**
+     * @brief Counts the number of edge mismatches in a given puzzle, one edge at a time.
+     *
+     * This is the portable reference kernel used when AVX2 is not available.
+     *
+     * @param puzzle The puzzle to score.
+     * @param edge_table The edge table giving the [top, right, bottom, left] motifs of each gene.
+     * @return The total number of edge mismatches in the puzzle.
+     */
+    static int countEdgeMismatchScalar(const Gene* puzzle, const EdgeTable &edge_table);
+
+    /**
+     * @brief Whether the AVX2 kernels apply: they hold one 8-tile row of one-byte genes per vector.
+     */
+    static constexpr bool HAS_AVX2_KERNELS = PUZZLE_WIDTH == 8 && PUZZLE_HEIGHT == 8 && sizeof(Gene) == 1;
+
+    /**
+     * @brief Counts the number of edge mismatches in a given puzzle with AVX2.
+     *
+     * Each 8-tile row is one vector: edges are gathered from the edge table, the
+     * right-edge plane is compared with the left-edge plane shifted by one lane and
+     * the bottom-edge plane with the top-edge plane of the next row, and mismatches
+     * are counted with movemask and popcount. Falls back to countEdgeMismatchScalar
+     * on compilers or architectures without AVX2 support and for puzzles other than
+     * 8x8 (see HAS_AVX2_KERNELS); only call it directly when hasAVX2() is true.
+     *
+     * @param puzzle The puzzle to score.
+     * @param edge_table The edge table giving the [top, right, bottom, left] motifs of each gene.
+     * @return The total number of edge mismatches in the puzzle.
+     */
+    EVOL_PUZZLE_TARGET_AVX2 static int countEdgeMismatchAVX2(const Gene* puzzle, const EdgeTable &edge_table);
+
+    /**
+     * @brief Counts the number of edge mismatches in a given puzzle.
+     *
+     * This function checks the mismatches between adjacent tiles in a puzzle.
+     * It considers both the left and top edges of each tile and compares them
+     * with the corresponding edges of the neighboring tiles. The kernel
+     * (countEdgeMismatchAVX2 or countEdgeMismatchScalar) is selected once at
+     * startup from the CPU features.
+     *
+     * @param puzzle The puzzle to score.
+     * @param edge_table The edge table giving the [top, right, bottom, left] motifs of each gene.
+     * @return The total number of edge mismatches in the puzzle.
+     */
+    static int countEdgeMismatch(const Gene* puzzle, const EdgeTable &edge_table);
+
+
+    /**
+     * @brief Performs a one-point crossover on two parent matrices.
+     * 
+     * This function takes two parent matrices and performs a one-point crossover
+     * to produce offspring. The crossover point is chosen randomly, and the 
+     * elements of the matrices are swapped at that point to create new offspring.
+     * 
+     * @param parent1 A pointer to the first parent matrix.
+     * @param parent2 A pointer to the second parent matrix.
+     */
+    static int onePointCrossover(Puzzle parent1, Puzzle parent2, Rng &rng);
+
+
+    /**
+     * @brief Performs a two-point crossover on two parent matrices.
+     *
+     * This function takes two parent matrices and performs a two-point crossover
+     * to generate offspring. The crossover points are chosen randomly, and the
+     * segments between these points are swapped between the two parents.
+     *
+     * @param parent1 A pointer to the first parent matrix.
+     * @param parent2 A pointer to the second parent matrix.
+     */
+    static pair<int, int>  twoPointCrossover(Puzzle parent1, Puzzle parent2, Rng &rng);
+
+    /**
+     * @brief Performs an order crossover (OX) on two offspring.
+     *
+     * The genes between two random crossover points are exchanged between the offspring,
+     * and the remaining positions of each offspring are filled, starting after the second
+     * crossover point, with the tiles of its own parent that are not already placed, in
+     * the order they appear in that parent. Tiles keep the rotation they had in the parent
+     * they are copied from, so both offspring remain permutations of the input tiles.
+     *
+     * @param offspring1 The first offspring, holding a copy of the first parent on entry.
+     * @param offspring2 The second offspring, holding a copy of the second parent on entry.
+     * @param rng The random stream used to pick the crossover points.
+     */
+    static void orderCrossover(Puzzle offspring1, Puzzle offspring2, Rng &rng);
+
+    /**
+     * @brief Evolves a population of solutions over a specified number of generations.
+     *
+     * This function performs genetic algorithm operations such as crossover and mutation
+     * on a population of solutions. It evaluates the fitness of the population after each
+     * generation and tracks the minimum edge mismatch count.
+     *
+     * @param population_arr The population of solutions.
+     * @param NUM_OF_GENERATIONS The number of generations to evolve the population.
+     * @param POPULATION_SIZE The size of the population.
+     * @param rng The random stream driving every operator of the run.
+     * @param island When not null, the population is one island of an island-model run:
+     *               it exchanges migrants with the other islands every migration interval,
+     *               stops once any island is solved, and reports its best puzzle through
+     *               the island instead of printing it.
+     * @param selection_method How parents are picked. Every method but truncation skips the
+     *                         ranking of evaluateFitness, except in generations that migrate,
+     *                         and picks parents among the individuals that are not replaced.
+     * @param local_search_method How the mutated offspring are improved by localSearch once the
+     *                            best edge mismatch count is at most LOCAL_SEARCH_THRESHOLD.
+     * @param completion_node_limit Node budget of completeExact on the best individual once its
+     *                              edge mismatch count is at most EXACT_COMPLETION_THRESHOLD
+     *                              (see shouldCompleteExact); 0 disables the exact completion.
+     */
+    static void evolve(Population &population_arr, int NUM_OF_GENERATIONS, const int POPULATION_SIZE, const EdgeTable &edge_table, Rng &rng, bool print_flag, Island* island = nullptr, SelectionMethod selection_method = TRUNCATION_SELECTION, LocalSearchMethod local_search_method = NO_LOCAL_SEARCH, long long completion_node_limit = 0);
+
+    /**
+     * @brief Evolves a population with a steady-state genetic algorithm.
+     *
+     * Instead of ranking and replacing a quarter of the population every generation,
+     * every step picks two parents by tournament, builds two children and lets each
+     * replace the current worst individual right away if it is not worse, so good
+     * children can be selected in the very next step. The worst individual comes from a
+     * FitnessBuckets, so no step sorts. A generation is as many children as a generation
+     * of evolve produces, which keeps the two engines comparable per evaluation.
+     * Crossover, mutation (with its rotation repair), mutation rate and stagnation restarts follow evolve.
+     *
+     * @param population_arr The population of solutions, with every individual generated.
+     * @param NUM_OF_GENERATIONS The number of generations to evolve the population.
+     * @param POPULATION_SIZE The size of the population.
+     * @param edge_table The edge table built from the input puzzle.
+     * @param rng The random stream driving every operator of the run.
+     * @param print_flag Whether to print the progress of every generation.
+     * @param best_puzzle Receives the best puzzle found.
+     * @param local_search_method How each child is improved by hillClimb before it is inserted,
+     *                            once the best edge mismatch count is at most LOCAL_SEARCH_THRESHOLD.
+     * @param completion_node_limit Node budget of completeExact on the best individual, checked
+     *                              after every generation as in evolve; 0 disables it.
+     * @return The lowest edge mismatch count found.
+     */
+    static int evolveSteadyState(Population &population_arr, int NUM_OF_GENERATIONS, const int POPULATION_SIZE, const EdgeTable &edge_table, Rng &rng, bool print_flag, Puzzle best_puzzle, LocalSearchMethod local_search_method = NO_LOCAL_SEARCH, long long completion_node_limit = 0);
+
+    /**
+     * @brief Solves the puzzle by simulated annealing, optionally with parallel tempering.
+     *
+     * Every replica is a single puzzle moved by random tile swaps and rotations, each
+     * scored in O(1) with the same local kernels as mutate (swapTileDelta and
+     * countLocalEdgeMismatch) and accepted by the Metropolis rule. A generation is as
+     * many moves per replica as evolve makes children, so generation counts compare
+     * with the GA engines.
+     *
+     * The temperature follows settings.schedule from the initial to the final temperature
+     * over the run. After settings.reheat_interval generations without a new best it
+     * goes back to ANNEALING_REHEAT_FRACTION of the initial temperature and cools again
+     * over the remaining generations. With more than one replica the coldest follows the
+     * schedule, the hottest stays at the initial temperature and the others are spaced
+     * geometrically between. The replicas move in parallel on the OpenMP threads, and
+     * after every generation neighbouring temperatures exchange their puzzles with the
+     * usual parallel tempering probability. Each replica has its own random stream and
+     * the exchanges use the caller's, so a run depends on the seed only, not the
+     * number of threads.
+     *
+     * @param puzzle The input puzzle, used by RANDOM_INITIALIZATION.
+     * @param NUM_OF_GENERATIONS The number of generations.
+     * @param POPULATION_SIZE The population size of the GA run to compare with; a
+     *                        generation is a quarter of it in moves per replica.
+     * @param edge_table The edge table built from the input puzzle.
+     * @param rng The random stream of the run.
+     * @param print_flag Whether to print the progress of every generation.
+     * @param best_puzzle Receives the best puzzle found.
+     * @param settings The cooling schedule, temperatures, reheats and replica count.
+     * @param initialization_method How every replica's first puzzle is built: greedyConstruct,
+     *                              or random moves of the input puzzle.
+     * @return The lowest edge mismatch count found.
+     */
+    static int anneal(const Gene* puzzle, int NUM_OF_GENERATIONS, const int POPULATION_SIZE, const EdgeTable &edge_table, Rng &rng, bool print_flag, Puzzle best_puzzle, const AnnealingSettings &settings, InitializationMethod initialization_method = RANDOM_INITIALIZATION);
+
+    /**
+     * @brief Picks an individual by tournament.
+     *
+     * Draws TOURNAMENT_SIZE individuals uniformly with replacement and returns the one
+     * with the lowest cached edge mismatch count, in O(TOURNAMENT_SIZE) and without sorting.
+     *
+     * @param population_arr The population, with every cached fitness up to date.
+     * @param POPULATION_SIZE The size of the population.
+     * @param rng The random stream the contestants are drawn from.
+     * @return The index of the winner.
+     */
+    static int tournamentSelect(const Population &population_arr, const int POPULATION_SIZE, Rng &rng);
+
+    /**
+     * @brief Buckets every individual of a population by its cached fitness.
+     *
+     * @param population_arr The population, with every cached fitness up to date.
+     * @param POPULATION_SIZE The size of the population.
+     * @param buckets Receives the buckets; their storage is reused across calls.
+     */
+    static void buildFitnessBuckets(const Population &population_arr, const int POPULATION_SIZE, FitnessBuckets &buckets);
+
+    /**
+     * @brief Adds an individual to the bucket of its fitness.
+     */
+    static void insertIntoBuckets(FitnessBuckets &buckets, int individual, int fitness);
+
+    /**
+     * @brief Removes an individual from the bucket of its fitness.
+     */
+    static void removeFromBuckets(FitnessBuckets &buckets, int individual, int fitness);
+
+    /**
+     * @brief Returns an individual with the highest edge mismatch count.
+     */
+    static int worstInBuckets(FitnessBuckets &buckets);
+
+    /**
+     * @brief Returns an individual with the lowest edge mismatch count.
+     */
+    static int bestInBuckets(FitnessBuckets &buckets);
+
+    /**
+     * @brief Pushes a migrant onto a migration queue without blocking.
+     *
+     * Must only be called by the queue's sending island.
+     *
+     * @param queue The queue.
+     * @param puzzle The genome to send.
+     * @param fitness The genome's edge mismatch count.
+     * @return False if the queue was full and the migrant was dropped.
+     */
+    static bool pushMigrant(MigrationQueue &queue, const Gene* puzzle, int fitness);
+
+    /**
+     * @brief Pops a migrant from a migration queue without blocking.
+     *
+     * Must only be called by the queue's receiving island.
+     *
+     * @param queue The queue.
+     * @param puzzle Receives the genome.
+     * @param fitness Receives the genome's edge mismatch count.
+     * @return False if the queue was empty.
+     */
+    static bool popMigrant(MigrationQueue &queue, Gene* puzzle, int &fitness);
+
+    /**
+     * @brief Exchanges migrants between an island and its neighbours.
+     *
+     * The island first sends copies of its migrant_count best individuals to its
+     * destinations under the group's topology, then drains its incoming queues, each
+     * migrant overwriting one of the worst individuals, and finally re-ranks the
+     * population so the migrants can be selected as parents in the same generation.
+     *
+     * @param population_arr The island's population.
+     * @param POPULATION_SIZE The size of the population.
+     * @param ratio_adjusted_pop_size The number of best and worst entries the ranking needs.
+     * @param sorted_index_by_fitness_vec The current ranking, updated in place.
+     * @param island The island.
+     * @param rng The island's random stream, used by the random topology.
+     * @return The number of migrants received.
+     */
+    static int migrate(Population &population_arr, const int POPULATION_SIZE, const int ratio_adjusted_pop_size, vector<pair<int, int>> &sorted_index_by_fitness_vec, Island &island, Rng &rng);
+
+    /**
+     * @brief Solves the puzzle with an island model: several populations evolving on their own threads.
+     *
+     * The total population is split into island_count islands. Each island is generated
+     * from the input puzzle with its own stream and runs evolve on its own OpenMP thread,
+     * migrating its best individuals every migration_interval generations. Without OpenMP
+     * the islands run one after another. Migration timing depends on thread scheduling, so
+     * island runs are not reproducible from the seed alone.
+     *
+     * @param puzzle The input puzzle, seed of every island.
+     * @param island_count The number of islands.
+     * @param POPULATION_SIZE The total population size, split evenly across islands.
+     * @param NUM_OF_GENERATIONS The number of generations each island runs for.
+     * @param edge_table The edge table built from the input puzzle.
+     * @param rng The random stream the island streams are derived from.
+     * @param topology The migration topology.
+     * @param migration_interval The number of generations between two migrations.
+     * @param migrant_count The number of best individuals sent per destination per migration.
+     * @param print_flag Whether island 0 prints its progress.
+     * @param selection_method How every island picks its parents.
+     * @param local_search_method How every island improves its offspring (see evolve).
+     * @param initialization_method How every island generates its first population.
+     * @param completion_node_limit Node budget of every island's exact completion (see evolve).
+     * @param best_puzzle Receives the best puzzle of the best island, unless it is null.
+     * @return The lowest edge mismatch count found by any island.
+     */
+    static int evolveIslands(const Gene* puzzle, int island_count, const int POPULATION_SIZE, int NUM_OF_GENERATIONS, const EdgeTable &edge_table, Rng &rng, MigrationTopology topology, int migration_interval, int migrant_count, bool print_flag, SelectionMethod selection_method = TRUNCATION_SELECTION, LocalSearchMethod local_search_method = NO_LOCAL_SEARCH, InitializationMethod initialization_method = RANDOM_INITIALIZATION, long long completion_node_limit = 0, Puzzle best_puzzle = nullptr);
+
+    /**
+     * @brief Solves the puzzle with an island model where every island is a separate process.
+     *
+     * The launcher maps one POSIX shared memory segment holding the IslandGroup, one
+     * ProcessSlot per island and all migration queues, then forks process_count islands.
+     * Each island registers its pid and marks itself running in the segment, so peers
+     * only send to registered, live islands. The islands then run evolve and exchange
+     * packed genomes through the same lock-free queues the threaded model uses.
+     *
+     * The segment name is unlinked as soon as it is mapped, so nothing is left behind
+     * whatever way the processes end. An island reaching 0 edge mismatches sets the
+     * shared solved flag and the others stop at their next generation. An island that
+     * crashes is reaped by the launcher and marked crashed, so the others stop sending
+     * to it and the run finishes with the remaining islands. Each island uses
+     * 1 / process_count of the OpenMP threads. On Windows this falls back to evolveIslands.
+     *
+     * @param puzzle The input puzzle, seed of every island.
+     * @param process_count The number of island processes.
+     * @param POPULATION_SIZE The total population size, split evenly across islands.
+     * @param NUM_OF_GENERATIONS The number of generations each island runs for.
+     * @param edge_table The edge table built from the input puzzle.
+     * @param rng The random stream the island streams are derived from.
+     * @param topology The migration topology.
+     * @param migration_interval The number of generations between two migrations.
+     * @param migrant_count The number of best individuals sent per destination per migration.
+     * @param print_flag Whether island 0 prints its progress.
+     * @param selection_method How every island picks its parents.
+     * @param local_search_method How every island improves its offspring (see evolve).
+     * @param initialization_method How every island generates its first population.
+     * @param completion_node_limit Node budget of every island's exact completion (see evolve).
+     * @param best_puzzle Receives the best puzzle of the best island, unless it is null.
+     * @return The lowest edge mismatch count found by any island that finished, or -1 if none did.
+     */
+    static int evolveProcesses(const Gene* puzzle, int process_count, const int POPULATION_SIZE, int NUM_OF_GENERATIONS, const EdgeTable &edge_table, Rng &rng, MigrationTopology topology, int migration_interval, int migrant_count, bool print_flag, SelectionMethod selection_method = TRUNCATION_SELECTION, LocalSearchMethod local_search_method = NO_LOCAL_SEARCH, InitializationMethod initialization_method = RANDOM_INITIALIZATION, long long completion_node_limit = 0, Puzzle best_puzzle = nullptr);
+
+    /**
+     * @brief Mutates a population of puzzles by performing random rotations and swaps.
+     * 
+     * This function iterates over each puzzle in the population and performs a series of 
+     * random rotations and swaps on the tiles within each puzzle. The number of rotations 
+     * and swaps is determined randomly for each puzzle.
+     * 
+     * @param offspring_arr The population of puzzles to mutate.
+     * @param POPULATION_SIZE The number of puzzles in the population.
+     * @param edge_table The edge table used to update each puzzle's cached fitness in O(1) per move.
+     *                   Puzzles given more than MAX_DELTA_TRACKED_MOVES moves are marked dirty instead.
+     * 
+     * Puzzles are mutated as runWorkStealing tasks, each with its own stream derived
+     * from rng, so the result does not depend on the thread count or scheduling. For each puzzle, it generates
+     * a random number of iterations and performs 
+     * the following operations:
+     * - Turns a randomly selected tile to its best rotation for its neighbours
+     *   (bestRotationDelta), or rotates it by one (rotateGene) once the puzzle is dirty.
+     * - Swaps tiles within the puzzle.
+     * Every puzzle then gets repairRotations, so no tile is left in a rotation that
+     * mismatches more edges than another one would.
+     */
+    static void mutate(Population &offspring_arr, const int POPULATION_SIZE, const EdgeTable &edge_table, Rng &rng, int mutation_rate);
+
+    /**
+     * @brief Mutates the given individuals of a population.
+     *
+     * Same as mutate over a whole population, except that task k mutates individual
+     * individual_index_vec[k] with stream k. evolve uses it on the offspring that
+     * crossover built in the slots they replace.
+     *
+     * @param population_arr The population.
+     * @param individual_index_vec The individuals to mutate, without duplicates.
+     * @param edge_table The edge table used to update each puzzle's cached fitness.
+     * @param rng The random stream the per-individual streams are derived from.
+     * @param mutation_rate The exclusive upper bound on the number of moves per individual.
+     */
+    static void mutate(Population &population_arr, const vector<int> &individual_index_vec, const EdgeTable &edge_table, Rng &rng, int mutation_rate);
+
+    /**
+     * @brief Improves a puzzle by hill climbing over tile swaps and rotations.
+     *
+     * Every move is scored in O(1) with swapTileDelta or rotateGeneDelta, and only moves
+     * touching a position with a mismatching edge are tried. First improvement keeps
+     * every improving move as soon as it is found; best improvement scores a whole pass
+     * and keeps its best move. The search stops at a local optimum or once either budget
+     * is spent.
+     *
+     * @param puzzle The puzzle, improved in place.
+     * @param edge_table The edge table built from the input puzzle.
+     * @param method FIRST_IMPROVEMENT_LOCAL_SEARCH or BEST_IMPROVEMENT_LOCAL_SEARCH; NO_LOCAL_SEARCH does nothing.
+     * @param move_budget The most moves scored.
+     * @param time_budget_us The most time spent, in microseconds.
+     * @return The change in edge mismatch count, never positive.
+     */
+    static int hillClimb(Puzzle puzzle, const EdgeTable &edge_table, LocalSearchMethod method, int move_budget, int time_budget_us);
+
+    /**
+     * @brief Improves the given individuals of a population with hillClimb.
+     *
+     * Each individual is one runWorkStealing task with LOCAL_SEARCH_MOVE_BUDGET moves and
+     * LOCAL_SEARCH_TIME_BUDGET_US microseconds, and its cached fitness is updated with the
+     * returned delta unless it is dirty. evolve runs it on the mutated offspring once the
+     * best edge mismatch count is at most LOCAL_SEARCH_THRESHOLD.
+     *
+     * @param population_arr The population.
+     * @param individual_index_vec The individuals to improve, without duplicates.
+     * @param edge_table The edge table built from the input puzzle.
+     * @param method The hill-climbing strategy; NO_LOCAL_SEARCH does nothing.
+     */
+    static void localSearch(Population &population_arr, const vector<int> &individual_index_vec, const EdgeTable &edge_table, LocalSearchMethod method);
+
+    /**
+     * @brief Searches for a zero-mismatch arrangement of the input tiles.
+     *
+     * A deterministic depth-first backtracking search over the positions in row order.
+     * Each position only tries the input tile classes (tiles equal up to rotation) whose
+     * top and left motifs match its placed neighbours, looked up in a precomputed
+     * (top, left) index, and a bitset tracks which classes still have unplaced tiles, so
+     * duplicate tiles are placed by multiplicity rather than tried one by one.
+     *
+     * With split_depth > 0 the placements of the first split_depth positions are
+     * enumerated and the subtree below each becomes a runWorkStealing task. Tasks after
+     * one that found a solution give up, so the solution is the first in depth-first
+     * order whatever the number of threads, as long as the node budget does not run out.
+     *
+     * @param solution Receives the solution, if one is found.
+     * @param edge_table The edge table built from the input puzzle.
+     * @param node_limit The most positions the search may try to fill, across all threads,
+     *                   checked every few thousand positions.
+     * @param node_count Receives the number of positions the search tried to fill.
+     * @param split_depth The number of leading positions enumerated before the search is
+     *                    split into parallel tasks; 0 searches on the calling thread.
+     * @return true if a solution was found. false with node_count < node_limit means
+     *         the puzzle has no solution.
+     */
+    static bool solveExact(Puzzle solution, const EdgeTable &edge_table, long long node_limit, long long &node_count, int split_depth = 0);
+
+    /**
+     * @brief Completes a near-solved puzzle by exact search over its mismatched positions.
+     *
+     * Positions without a mismatched edge are frozen, and the tiles on the others are
+     * placed again by the backtracking search of solveExact, every placement matching
+     * the frozen tiles around it. If that region has no completion, it grows by its
+     * frozen neighbours and the search starts over, until the node budget runs out.
+     * Makes no heap allocation.
+     *
+     * @param puzzle The puzzle; replaced by the completion if one is found.
+     * @param edge_table The edge table built from the input puzzle.
+     * @param node_limit The most positions the searches may try to fill, across all regions.
+     * @param node_count Receives the number of positions the searches tried to fill.
+     * @return true if the puzzle now has no mismatch.
+     */
+    static bool completeExact(Puzzle puzzle, const EdgeTable &edge_table, long long node_limit, long long &node_count);
+
+    /**
+     * @brief Performs crossover operation on a population array.
+     * 
+     * This function iterates through the population array in pairs and applies
+     * a two-point crossover operation on each pair. The crossover is performed
+     * only if there is a valid pair (i.e., the second individual in the pair exists).
+     * 
+     * @param population_arr The population the parents are taken from and the offspring written to.
+     * @param POPULATION_SIZE The size of the population array.
+     * @param offspring_index_vec The slots the offspring replace, one per parent and disjoint from
+     *                            the parents (evolve passes the worst individuals).
+     *
+     * Offspring inherit their parent's cached fitness; those recombined by orderCrossover
+     * are marked dirty instead and rescored by refreshFitness.
+     *
+     * Pairs are independent tasks run by runWorkStealing: they are built directly in
+     * the slots they replace, so survivor replacement needs no further copy, each with its own stream derived from rng, so no scratch
+     * puzzles are shared and the offspring do not depend on the thread count or on which
+     * thread ran which pair.
+     */
+    static void crossover(Population &population_arr, const int POPULATION_SIZE, const vector<int> &parent_indexes_vec, const vector<int> &offspring_index_vec, int min_edge_mismatch_count, Rng &rng);
+
+    /**
+     * @brief Evaluates the fitness of a population of puzzle solutions.
+     *
+     * This function ranks a population of puzzle solutions by their cached edge mismatch
+     * count (Population::fitness). The operators keep the cache exact or mark the individual
+     * dirty, and refreshFitness rescores the dirty ones, so no individual is rescored here.
+     * The ranking is an O(N) counting sort over [0, MAX_EDGE_MISMATCH_COUNT] that writes
+     * into the caller's vector; out-of-range values fall back to rankByFitnessPartial.
+     *
+     * @param population_arr The population of puzzle solutions.
+     * @param POPULATION_SIZE The number of puzzle solutions in the population.
+     * @param ratio_adjusted_pop_size The number of best and worst entries the caller needs.
+     * @param sorted_index_by_fitness_vec Receives the <index, edge mismatch count> pairs sorted by descending mismatch count.
+     */
+    static void evaluateFitness(const Population &population_arr, const int POPULATION_SIZE, const int ratio_adjusted_pop_size, vector<pair<int, int>> &sorted_index_by_fitness_vec);
+
+    /**
+     * @brief Ranks only the best and worst entries of a population with nth_element.
+     *
+     * Fallback for fitness values outside [0, MAX_EDGE_MISMATCH_COUNT]. The first
+     * ratio_adjusted_pop_size entries are the worst, the last ratio_adjusted_pop_size
+     * entries are the best with the single best at the back; each group is unordered.
+     *
+     * @param population_arr The population of puzzle solutions.
+     * @param POPULATION_SIZE The number of puzzle solutions in the population.
+     * @param ratio_adjusted_pop_size The number of best and worst entries to separate out.
+     * @param sorted_index_by_fitness_vec Receives the partially ordered <index, fitness> pairs.
+     */
+    static void rankByFitnessPartial(const Population &population_arr, const int POPULATION_SIZE, const int ratio_adjusted_pop_size, vector<pair<int, int>> &sorted_index_by_fitness_vec);
+
+    /**
+     * @brief Scores a range of individuals and writes their fitness into a preallocated array.
+     *
+     * With AVX2 the individuals are scored 8 at a time in a transposed layout where lane k
+     * of every vector belongs to individual k, which keeps the SIMD units busy and removes
+     * the per-individual call and reduction overhead. Otherwise each individual is scored
+     * with countEdgeMismatch.
+     *
+     * @param population_arr The population of puzzle solutions.
+     * @param start_index The first individual to score.
+     * @param end_index One past the last individual to score.
+     * @param edge_table The edge table built from the input puzzle.
+     * @param fitness_arr Receives the edge mismatch count of individual i at index i.
+     */
+    static void evaluateFitnessBatch(const Population &population_arr, const int start_index, const int end_index, const EdgeTable &edge_table, int* fitness_arr);
+
+    /**
+     * @brief Rescores the individuals whose cached fitness is marked dirty.
+     *
+     * Individuals are marked dirty by allocatePopulation, generatePopulation and
+     * orderCrossover offspring. Runs of consecutive dirty individuals are scored
+     * together with evaluateFitnessBatch, with each OpenMP thread scanning its own block.
+     *
+     * @param population_arr The population whose cache is refreshed.
+     * @param POPULATION_SIZE The number of individuals in the population.
+     * @param edge_table The edge table built from the input puzzle.
+     * @return The number of individuals that were rescored.
+     */
+    static int refreshFitness(Population &population_arr, const int POPULATION_SIZE, const EdgeTable &edge_table);
+
+    /**
+     * @brief Selects the indices of the parent puzzles and the worst puzzles from the population.
+     * 
+     * This function selects the top-ranking puzzles as parents and the bottom-ranking puzzles as the worst
+     * based on their fitness values. The selection is done using a sorted index vector.
+     * 
+     * @param population_arr The population of puzzles.
+     * @param POPULATION_SIZE The total size of the population.
+     * @param sorted_index_by_fitness_vec A vector of pairs where each pair contains an index and its corresponding fitness value, sorted by fitness.
+     * @param ratio_adjusted_pop_size The number of top-ranking puzzles to select as parents and the number of bottom-ranking puzzles to select as worst.
+     * 
+     * @param parents_index_vec Receives the indices of the selected parent puzzles.
+     * @param worst_index_vec Receives the indices of the selected worst puzzles.
+     */
+    static void selectParentsAndWorst(const Population &population_arr, const int POPULATION_SIZE, const vector<pair<int, int>> &sorted_index_by_fitness_vec, const int ratio_adjusted_pop_size, vector<int> &parents_index_vec, vector<int> &worst_index_vec);
+
+    /**
+     * @brief A parent selection operator that works on the cached fitness without ranking.
+     *
+     * Fills every entry of parent_index_vec with an individual not marked in excluded.
+     * wheel is scratch storage the operator may resize, reused across calls so the
+     * steady state does not allocate.
+     */
+    typedef void (*ParentSelector)(const Population &population_arr, const int POPULATION_SIZE, const vector<uint8_t> &excluded, vector<int> &parent_index_vec, vector<double> &wheel, Rng &rng);
+
+    /**
+     * @brief Finds the worst individuals and the best one without ranking the population.
+     *
+     * A histogram of the cached fitness gives the edge mismatch count the worst
+     * individuals start at, and a second pass collects them, so this is O(N) and much
+     * cheaper than the full ranking of evaluateFitness. Ties are taken in index order, as
+     * evaluateFitness does.
+     *
+     * @param population_arr The population, with every cached fitness up to date.
+     * @param POPULATION_SIZE The size of the population.
+     * @param worst_count The number of worst individuals to find.
+     * @param worst_index_vec Receives the worst individuals.
+     * @return The index of an individual with the lowest edge mismatch count.
+     */
+    static int selectWorstUnranked(const Population &population_arr, const int POPULATION_SIZE, const int worst_count, vector<int> &worst_index_vec);
+
+    /**
+     * @brief Tournament selection: every parent is the best of TOURNAMENT_SIZE random individuals.
+     *
+     * O(TOURNAMENT_SIZE) per parent. See ParentSelector for the parameters.
+     */
+    static void tournamentSelection(const Population &population_arr, const int POPULATION_SIZE, const vector<uint8_t> &excluded, vector<int> &parent_index_vec, vector<double> &wheel, Rng &rng);
+
+    /**
+     * @brief Stochastic universal sampling, proportional to the number of matched edges.
+     *
+     * Individual i gets MAX_EDGE_MISMATCH_COUNT - fitness + 1 slots on the wheel, and all
+     * parents are read with one spin of equally spaced pointers, so the number of copies
+     * of each individual stays within one of its expectation. O(N). See ParentSelector
+     * for the parameters.
+     */
+    static void stochasticUniversalSampling(const Population &population_arr, const int POPULATION_SIZE, const vector<uint8_t> &excluded, vector<int> &parent_index_vec, vector<double> &wheel, Rng &rng);
+
+    /**
+     * @brief Roulette-wheel selection weighted by rank.
+     *
+     * An individual's weight is one plus the number of individuals it beats, counted
+     * with a fitness histogram instead of a sort. The independent spins are generated
+     * already in increasing order, so the wheel is built and read in O(N + k). See
+     * ParentSelector for the parameters.
+     */
+    static void rankRouletteSelection(const Population &population_arr, const int POPULATION_SIZE, const vector<uint8_t> &excluded, vector<int> &parent_index_vec, vector<double> &wheel, Rng &rng);
+
+    /**
+     * @brief Returns the operator of a selection method.
+     *
+     * @param selection_method The selection method.
+     * @return The operator, or null for TRUNCATION_SELECTION, which needs the ranking.
+     */
+    static ParentSelector getParentSelector(SelectionMethod selection_method);
+
+    /**
+     * @brief Copies the contents of one puzzle to another.
+     * 
+     * This function copies the contents of the source puzzle to the destination puzzle.
+     * Both puzzles are contiguous blocks of TILES_IN_PUZZLE_COUNT genes, so the copy
+     * is a single memcpy.
+     * 
+     * @param source_puzzle The source puzzle to copy from.
+     * @param dest_puzzle The destination puzzle to copy to.
+     */
+    static void copyPuzzle(const Gene* source_puzzle, Puzzle dest_puzzle);
+
+    /**
+     * @brief Copies the tile placed at one position to another.
+     * 
+     * This function copies the gene (tile index and rotation) of the source position
+     * to the destination position, which is a single byte store.
+     * 
+     * @param source_tile The source gene.
+     * @param dest_tile The destination gene.
+     */
+    static void copyTile(Gene source_tile, Gene &dest_tile);
+
+    /**
+     * @brief Copies a source puzzle into each element of a destination population.
+     * 
+     * This function iterates over a population array and copies the source puzzle 
+     * into each individual in the population.
+     * 
+     * @param destination_population The population where each individual is to be
+     *        filled with the source puzzle.
+     * @param POPULATION_SIZE The number of individuals in the population.
+     * @param source_puzzle The puzzle to be copied into each individual of the population.
+     */
+    static void writePuzzleIntoPopulation(Population &destination_population, const int POPULATION_SIZE, Puzzle source_puzzle);
+
+    /**
+     * @brief Prints the puzzle in a formatted manner.
+     * 
+     * This function takes a 2D array representing a puzzle and prints it to the console.
+     * Each tile in the puzzle is printed in a row, and a new line is started after every 8 tiles.
+     * 
+     * @param puzzle The puzzle to print.
+     * @param edge_table The edge table used to convert genes back to the four-digit format.
+     */
+    static void printPuzzle(const Gene* puzzle, const EdgeTable &edge_table);
+
+    /**
+     * @brief Saves the puzzle state to a file in the "output" directory.
+     *
+     * This function creates an "output" directory if it does not already exist.
+     * It then generates a filename based on the current date and time, and the
+     * provided edge mismatch count. The puzzle state is written to this file.
+     *
+     * @param puzzle The puzzle state.
+     * @param edge_table The edge table used to convert genes back to the four-digit format.
+     * @param edge_mismatch_count The count of edge mismatches in the puzzle.
+     *
+     * @note The function assumes that the puzzle is a square grid with a size
+     *       defined by TILES_IN_PUZZLE_COUNT and TILE_SIZE.
+     * @note The function will output an error message to std::cerr if it fails
+     *       to create the directory or open the file for writing.
+     */
+    static void savePuzzle(const Gene* puzzle, const EdgeTable &edge_table, int edge_mismatch_count);
+
+private:
+    // Helpers of the operators and engines, defined and documented in evol-puzzle.cpp.
+    static constexpr int EXACT_CLASS_WORDS = (TILES_IN_PUZZLE_COUNT + 63) / 64;
+
+    struct AnnealingReplica;
+    struct MutationContext;
+    struct LocalSearchContext;
+    struct ExactIndex;
+    struct ExactSearch;
+    struct ExactContext;
+    struct CrossoverContext;
+
+    static const EdgeMismatchKernel edge_mismatch_kernel;
+
+    static int countPairEdgeMismatch(const Gene* puzzle, int first_index, int second_index, const EdgeTable &edge_table);
+    static int collectCandidates(const CandidateIndex &candidate_index, int top, int left, const bool* used, Gene* candidates, int candidate_count);
+    EVOL_PUZZLE_TARGET_AVX2 static void evaluateFitnessBatchAVX2(const Population &population_arr, const int start_index, const int end_index, const EdgeTable &edge_table, int* fitness_arr);
+    static EdgeMismatchKernel selectEdgeMismatchKernel();
+    static void applyRandomMoves(Puzzle puzzle, int move_count, Rng &rng);
+    static void setReplicaTemperature(AnnealingReplica &replica, double temperature);
+    static void setLadderTemperatures(vector<AnnealingReplica> &replicas, double coldest_temperature, double hottest_temperature);
+    static void annealReplica(AnnealingReplica &replica, int move_count, const EdgeTable &edge_table);
+    static bool isIslandRunning(const IslandGroup &group, int index);
+    static void mutateIndividual(int task_index, void* context);
+    static void improveIndividual(int task_index, void* context);
+    static void buildExactIndex(const EdgeTable &edge_table, ExactIndex &index);
+    static void initExactSearch(ExactSearch &search, const EdgeTable &edge_table, const ExactIndex &index);
+    static void restrictExactSearch(ExactSearch &search, const Gene* puzzle, const bool* free);
+    static void placeExactEntry(ExactSearch &search, int depth, int entry);
+    static void removeExactEntry(ExactSearch &search, int depth, int entry);
+    static int facingMotif(const ExactSearch &search, int neighbour, int edge);
+    static bool searchExact(ExactSearch &search, int depth);
+    static void searchExactSubtree(int task_index, void* context);
+    static void crossoverPair(int pair_index, void* context);
+};
+
+// out-of-class definitions, so the constants can be bound to references (std::min, std::max)
+template<int WIDTH, int HEIGHT, int MOTIFS> constexpr int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::PUZZLE_WIDTH;
+template<int WIDTH, int HEIGHT, int MOTIFS> constexpr int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::PUZZLE_HEIGHT;
+template<int WIDTH, int HEIGHT, int MOTIFS> constexpr int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::TILES_IN_PUZZLE_COUNT;
+template<int WIDTH, int HEIGHT, int MOTIFS> constexpr int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::MAX_EDGE_MISMATCH_COUNT;
+template<int WIDTH, int HEIGHT, int MOTIFS> constexpr int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::MOTIF_COUNT;
+template<int WIDTH, int HEIGHT, int MOTIFS> constexpr int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::MOTIF_COMBINATION_COUNT;
+template<int WIDTH, int HEIGHT, int MOTIFS> constexpr int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::BITS_PER_EDGE;
+template<int WIDTH, int HEIGHT, int MOTIFS> constexpr int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::EDGE_MASK;
+template<int WIDTH, int HEIGHT, int MOTIFS> constexpr int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::TILE_MASK;
+template<int WIDTH, int HEIGHT, int MOTIFS> constexpr bool EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::HAS_AVX2_KERNELS;
+template<int WIDTH, int HEIGHT, int MOTIFS> constexpr int EvolPuzzle<WIDTH, HEIGHT, MOTIFS>::EXACT_CLASS_WORDS;
 
 /**
- * @brief Prints the puzzle in a formatted manner.
- * 
- * This function takes a 2D array representing a puzzle and prints it to the console.
- * Each tile in the puzzle is printed in a row, and a new line is started after every 8 tiles.
- * 
- * @param puzzle A 2D array representing the puzzle, where each sub-array is a tile.
+ * @brief EVOL_PUZZLE_FOR_EACH_SIZE(X) expands X(width, height) for every geometry the solver is instantiated for.
+ *
+ * Every square puzzle from 4x4 to 16x16, plus EVOL_PUZZLE_EXTRA_WIDTH x
+ * EVOL_PUZZLE_EXTRA_HEIGHT when both are defined at build time, e.g.
+ * -DEVOL_PUZZLE_EXTRA_WIDTH=10 -DEVOL_PUZZLE_EXTRA_HEIGHT=6 for a 10x6 board.
  */
-void printPuzzle(int** puzzle);
+#define EVOL_PUZZLE_FOR_EACH_SQUARE_SIZE(X) \
+    X(4, 4) X(5, 5) X(6, 6) X(7, 7) X(8, 8) X(9, 9) X(10, 10) \
+    X(11, 11) X(12, 12) X(13, 13) X(14, 14) X(15, 15) X(16, 16)
+
+#if defined(EVOL_PUZZLE_EXTRA_WIDTH) && defined(EVOL_PUZZLE_EXTRA_HEIGHT)
+    #if EVOL_PUZZLE_EXTRA_WIDTH == EVOL_PUZZLE_EXTRA_HEIGHT && EVOL_PUZZLE_EXTRA_WIDTH >= 4 && EVOL_PUZZLE_EXTRA_WIDTH <= 16
+        #error "EVOL_PUZZLE_EXTRA_WIDTH x EVOL_PUZZLE_EXTRA_HEIGHT is already instantiated"
+    #endif
+    #define EVOL_PUZZLE_FOR_EACH_SIZE(X) EVOL_PUZZLE_FOR_EACH_SQUARE_SIZE(X) X(EVOL_PUZZLE_EXTRA_WIDTH, EVOL_PUZZLE_EXTRA_HEIGHT)
+#else
+    #define EVOL_PUZZLE_FOR_EACH_SIZE(X) EVOL_PUZZLE_FOR_EACH_SQUARE_SIZE(X)
+#endif
 
 /**
- * @brief Saves the puzzle state to a file in the "output" directory.
+ * @brief Runs Run<W, H, M>::run(arguments) for the instantiation matching a puzzle shape.
  *
- * This function creates an "output" directory if it does not already exist.
- * It then generates a filename based on the current date and time, and the
- * provided edge mismatch count. The puzzle state is written to this file.
+ * M is SMALL_MOTIF_COUNT when the puzzle has at most that many motifs and
+ * MAX_MOTIF_COUNT otherwise (see readInputShape).
  *
- * @param puzzle A 2D array representing the puzzle state.
- * @param edge_mismatch_count The count of edge mismatches in the puzzle.
+ * @param width The number of tiles on each line of the puzzle.
+ * @param height The number of lines of the puzzle.
+ * @param motif_count The number of motifs of the puzzle.
+ * @param arguments Passed on to Run<W, H, M>::run.
+ * @return What Run<W, H, M>::run returns.
  *
- * @note The function assumes that the puzzle is a square grid with a size
- *       defined by TILES_IN_PUZZLE_COUNT and TILE_SIZE.
- * @note The function will output an error message to std::cerr if it fails
- *       to create the directory or open the file for writing.
+ * @throws runtime_error If no instantiation has that width and height.
  */
-void savePuzzle(int** puzzle, int edge_mismatch_count);
+template<template<int, int, int> class Run, class Arguments>
+int dispatchGeometry(int width, int height, int motif_count, Arguments &arguments){
+    const bool small_motifs = motif_count <= SMALL_MOTIF_COUNT;
+#define EVOL_PUZZLE_DISPATCH_SIZE(W, H) \
+    if (width == W && height == H){ \
+        return small_motifs ? Run<W, H, SMALL_MOTIF_COUNT>::run(arguments) : Run<W, H, MAX_MOTIF_COUNT>::run(arguments); \
+    }
+    EVOL_PUZZLE_FOR_EACH_SIZE(EVOL_PUZZLE_DISPATCH_SIZE)
+#undef EVOL_PUZZLE_DISPATCH_SIZE
+
+    ostringstream message;
+    message << "no solver for " << width << "x" << height << " puzzles, the square sizes 4x4 to 16x16 are built in"
+            << " (add another size with -DEVOL_PUZZLE_EXTRA_WIDTH and -DEVOL_PUZZLE_EXTRA_HEIGHT)";
+    throw runtime_error(message.str());
+}
@@ -7,8 +7,48 @@
  * over a specified number of generations.
  * 
  * @details
- * The program expects an optional command-line argument:
+ * The program accepts optional command-line arguments:
  * - `-v` : Enables verbose output.
+ * - `--seed <n>` : Seeds the random streams so the run can be reproduced.
+ *   Without it a clock-derived seed is used; the seed is printed either way.
+ * - `--threads <n>` : Number of threads used by the parallel steps when built
+ *   with OpenMP (defaults to OMP_NUM_THREADS or the number of cores).
+ * - `--islands <k>` : Splits the population into k islands evolving on their own
+ *   threads and exchanging their best individuals (island model).
+ * - `--processes <n>` : Like --islands, but every island is a separate process and
+ *   migrants are exchanged through POSIX shared memory.
+ * - `--topology ring|full|random` : Island migration topology (default ring).
+ * - `--migration-interval <n>` : Generations between migrations (default 50).
+ * - `--migrants <m>` : Best individuals sent per destination per migration (default 2).
+ * - `--selection truncation|tournament|sus|rank-roulette` : How evolve picks parents
+ *   (default truncation). The other methods skip ranking the population.
+ * - `--local-search none|first|best` : Hill-climbs every offspring after mutation with
+ *   first- or best-improvement swap/rotate moves once the best edge mismatch count is
+ *   at most LOCAL_SEARCH_THRESHOLD (default none).
+ * - `--init random|greedy` : How the first population is generated: random moves of the
+ *   input order (default) or the randomized greedy constructor.
+ * - `--steady-state` : Evolves a single population with the steady-state engine
+ *   (tournament parents, each child replaces the worst at once) instead of evolve.
+ * - `--anneal` : Runs the simulated annealing engine (anneal) instead of evolve. A
+ *   generation is a quarter of the population size in moves per replica.
+ * - `--cooling geometric|linear|lundy-mees` : Annealing cooling schedule (default geometric).
+ * - `--temperatures <start> <end>` : Initial and final annealing temperatures (default
+ *   ANNEALING_INITIAL_TEMPERATURE and ANNEALING_FINAL_TEMPERATURE).
+ * - `--reheat-interval <n>` : Generations without a new best before annealing reheats
+ *   (default 0, never).
+ * - `--replicas <n>` : Annealing replicas; more than 1 runs parallel tempering with
+ *   replica exchange, the replicas spread over the OpenMP threads (default 1).
+ * - `--exact` : Runs the exact backtracking solver (solveExact) instead of evolving a
+ *   population, split into parallel subtree tasks when built with OpenMP. The
+ *   population size and number of generations are not asked for.
+ * - `--exact-nodes <n>` : Node budget of the exact solver (default EXACT_NODE_LIMIT).
+ * - `--completion-nodes <n>` : Node budget of the exact completion the engines run on their
+ *   best individual once it has at most EXACT_COMPLETION_THRESHOLD mismatches (default 0,
+ *   off; EXACT_COMPLETION_NODE_LIMIT is a good budget).
+ * 
+ * The puzzle size and motif count are read from Ass1Input.txt, and dispatchGeometry
+ * runs the EvolPuzzle instantiation built for that geometry; a shape without one is
+ * rejected.
  * 
  * The user is prompted to input the population size and the number of generations.
  * The program then measures the time taken to evolve the population and outputs
@@ -22,42 +62,121 @@
 #include "evol-puzzle.h"
 
 
-int main(int argc, char** argv){
-    bool print_flag = false;
-    if (argc > 1){
-        if (string(argv[1]) == "-v"){
-            print_flag = true;
+/**
+ * @brief Solves Ass1Input.txt with the EvolPuzzle instantiation for its geometry.
+ *
+ * Instantiated by dispatchGeometry once the shape of the input is known.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+struct PuzzleRun {
+    typedef EvolPuzzle<WIDTH, HEIGHT, MOTIFS> P;
+    typedef typename P::Tile Tile;
+    typedef typename P::Puzzle Puzzle;
+    typedef typename P::EdgeTable EdgeTable;
+    typedef typename P::Population Population;
+
+    static int run(RunOptions &options){
+        Rng rng = makeRng(options.seed, 0);
+
+        Tile input_tiles[P::TILES_IN_PUZZLE_COUNT];
+        try {
+            P::readInput("Ass1Input.txt", input_tiles);
+        } catch (const runtime_error &error) {
+            cerr << error.what() << endl;
+            return 1;
         }
-    }
+        EdgeTable edge_table = P::buildEdgeTable(input_tiles);
+        Puzzle puzzle = P::allocatePuzzle();
+        P::writeInputOrder(puzzle);
 
-    int POPULATION_SIZE;
-    int NUM_OF_GENERATIONS;
-    cout << "\n\nSelect population size: ";
-    cin >> POPULATION_SIZE;
-    cout << "Select number of generations: ";
-    cin >> NUM_OF_GENERATIONS;
-    auto start = chrono::high_resolution_clock::now();
+        if (options.steady_state_flag && (options.process_count > 1 || options.island_count > 1)){
+            cout << "--steady-state runs a single population, islands use evolve" << endl;
+        }
+        if (options.anneal_flag && (options.process_count > 1 || options.island_count > 1 || options.steady_state_flag)){
+            cout << "--anneal replaces the GA engines, use --replicas to run it in parallel" << endl;
+        }
+
+        if (options.exact_flag){
+            long long node_count;
+            Puzzle solution = P::allocatePuzzle();
+            if (P::solveExact(solution, edge_table, options.exact_node_limit, node_count, EXACT_SPLIT_DEPTH)){
+                cout << "\n\nExact solution found after " << node_count << " nodes:\n";
+                P::printPuzzle(solution, edge_table);
+                P::savePuzzle(solution, edge_table, 0);
+            } else if (node_count < options.exact_node_limit){
+                cout << "\n\nNo solution exists, search exhausted after " << node_count << " nodes" << endl;
+            } else {
+                cout << "\n\nNo solution within " << options.exact_node_limit << " nodes" << endl;
+            }
+            P::freePuzzle(solution);
+        } else if (options.anneal_flag){
+            Puzzle best_puzzle = P::allocatePuzzle();
+            int min_edge_mismatch_count = P::anneal(puzzle, options.NUM_OF_GENERATIONS, options.POPULATION_SIZE, edge_table, rng, options.print_flag, best_puzzle, options.annealing_settings, options.initialization_method);
+            cout << "\n\nBest Puzzle with " << min_edge_mismatch_count << " edge mismatches:\n";
+            P::printPuzzle(best_puzzle, edge_table);
+            P::freePuzzle(best_puzzle);
+        } else if (options.process_count > 1){
+            P::evolveProcesses(puzzle, options.process_count, options.POPULATION_SIZE, options.NUM_OF_GENERATIONS, edge_table, rng, options.topology, options.migration_interval, options.migrant_count, options.print_flag, options.selection_method, options.local_search_method, options.initialization_method, options.completion_node_limit);
+        } else if (options.island_count > 1){
+            P::evolveIslands(puzzle, options.island_count, options.POPULATION_SIZE, options.NUM_OF_GENERATIONS, edge_table, rng, options.topology, options.migration_interval, options.migrant_count, options.print_flag, options.selection_method, options.local_search_method, options.initialization_method, options.completion_node_limit);
+        } else {
+            Population population_arr = P::allocatePopulation(options.POPULATION_SIZE);
+
+            // Step 1: Initialization
+            P::initializePopulation(population_arr, puzzle, options.POPULATION_SIZE, edge_table, rng, options.initialization_method);
+
+            // Step 2-6 
+            if (options.steady_state_flag){
+                Puzzle best_puzzle = P::allocatePuzzle();
+                int min_edge_mismatch_count = P::evolveSteadyState(population_arr, options.NUM_OF_GENERATIONS, options.POPULATION_SIZE, edge_table, rng, options.print_flag, best_puzzle, options.local_search_method, options.completion_node_limit);
+                cout << "\n\nBest Puzzle with " << min_edge_mismatch_count << " edge mismatches:\n";
+                P::printPuzzle(best_puzzle, edge_table);
+                P::freePuzzle(best_puzzle);
+            } else {
+                P::evolve(population_arr, options.NUM_OF_GENERATIONS, options.POPULATION_SIZE, edge_table, rng, options.print_flag, nullptr, options.selection_method, options.local_search_method, options.completion_node_limit);
+            }
+
+            P::freePopulation(population_arr);
+        }
 
-    pair<mt19937, uniform_int_distribution<int>> random = getRandomGen();
     
-    int** puzzle = allocatePuzzle();
-    readInput("Ass1Input.txt", puzzle);
-    unordered_map<string, string> map_of_tiles = buildMapOfTiles(puzzle);
-    unordered_map<string, int> duplicatesMap = recordDuplicateTiles(puzzle);
-    int*** population_arr = allocatePopulation(POPULATION_SIZE);
+        P::freePuzzle(puzzle);
+        return 0;
+    }
+};
+
+
+int main(int argc, char** argv){
+    RunOptions options;
+    parseRunOptions(argc, argv, options);
 
-    // Step 1: Initialization
-    generatePopulation(population_arr, puzzle, POPULATION_SIZE, random);
+    if (!options.exact_flag){
+        cout << "\n\nSelect population size: ";
+        cin >> options.POPULATION_SIZE;
+        cout << "Select number of generations: ";
+        cin >> options.NUM_OF_GENERATIONS;
+    }
+    auto start = chrono::high_resolution_clock::now();
+
+    cout << "Seed: " << options.seed << endl;
 
-    // Step 2-6 
-    evolve(population_arr, NUM_OF_GENERATIONS, POPULATION_SIZE, duplicatesMap, map_of_tiles, random, print_flag);
+    int status;
+    try {
+        int width, height, motif_count;
+        readInputShape("Ass1Input.txt", width, height, motif_count);
+        status = dispatchGeometry<PuzzleRun>(width, height, motif_count, options);
+    } catch (const runtime_error &error) {
+        cerr << error.what() << endl;
+        return 1;
+    }
+    if (status != 0){
+        return status;
+    }
 
     auto end = chrono::high_resolution_clock::now();
     chrono::duration<double> elapsed = end - start;
 
     cout << "Time taken: " << elapsed.count() << " seconds" << endl;
 
-    delete population_arr;
-
     return 0;
 }
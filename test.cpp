@@ -3,168 +3,1241 @@
 #include <sstream>
 
 /**
- * @brief Compares two arrays for equality.
- * 
- * This function checks if two arrays of integers are equal by comparing
- * each element. The arrays are assumed to have a size of TILE_SIZE.
- * 
- * @param arr1 The first array to compare.
- * @param arr2 The second array to compare.
- * @return true if all elements in both arrays are equal, false otherwise.
+ * @brief The unit tests and benchmarks of the 8x8 instantiation, run on Ass1Input.txt.
+ *
+ * Deriving from the instantiation keeps its types and functions unqualified.
  */
-bool assertArrayEqual(const int* arr1, const int* arr2){
-    for (int i = 0; i < TILE_SIZE; i++){
-        if (arr1[i] != arr2[i]){
-            return false;
+struct PuzzleTest : EvolPuzzle<8, 8, SMALL_MOTIF_COUNT> {
+    /**
+     * @brief Compares two tiles for equality.
+     * 
+     * This function checks if two tiles are equal by comparing each of their
+     * TILE_SIZE edges.
+     * 
+     * @param tile1 The first tile to compare.
+     * @param tile2 The second tile to compare.
+     * @return true if all edges of both tiles are equal, false otherwise.
+     */
+    static bool assertArrayEqual(Tile tile1, Tile tile2){
+        for (int i = 0; i < TILE_SIZE; i++){
+            if (getEdge(tile1, i) != getEdge(tile2, i)){
+                return false;
+            }
         }
+        return true;
     }
-    return true;
-}
 
-int main(){
-    // --- Test rotateToLeftByOneIndex
-    int arr[] = {1,2,3,4};
-    int expected[] = {2,3,4,1};
-    rotateToLeftByOneIndex(arr);
-    assert(assertArrayEqual(arr, expected));
+    /**
+     * @brief Checks that a puzzle places every input tile exactly once.
+     * 
+     * @param puzzle The puzzle to check.
+     * @return true if the tile indices of the puzzle form a permutation, false otherwise.
+     */
+    static bool isPermutation(const Gene* puzzle){
+        bool seen[TILES_IN_PUZZLE_COUNT] = {false};
+        for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+            if (seen[getGeneTile(puzzle[i])]){
+                return false;
+            }
+            seen[getGeneTile(puzzle[i])] = true;
+        }
+        return true;
+    }
+
+    static void run(){
+        // --- Test packTile / getEdge
+        int edges[] = {1,2,3,4};
+        Tile arr = packTile(edges);
+        for (int i = 0; i < TILE_SIZE; i++){
+            assert(getEdge(arr, i) == edges[i]);
+        }
+        assert(convertTileToString(arr) == "1234");
+        // -------------------------------
+
+        // --- Test rotateToLeftByOneIndex
+        int expected_edges[] = {2,3,4,1};
+        Tile expected = packTile(expected_edges);
+        rotateToLeftByOneIndex(arr);
+        assert(assertArrayEqual(arr, expected));
 
-    rotateToLeftByOneIndex(arr);
-    int expected2[] = {3,4,1,2};
-    assert(assertArrayEqual(arr, expected2));
-    // -------------------------------
+        rotateToLeftByOneIndex(arr);
+        int expected2_edges[] = {3,4,1,2};
+        Tile expected2 = packTile(expected2_edges);
+        assert(assertArrayEqual(arr, expected2));
 
-    // --- Test swapTile
+        rotateToLeftByOneIndex(arr);
+        rotateToLeftByOneIndex(arr);
+        assert(assertArrayEqual(arr, packTile(edges)));
+        // -------------------------------
 
-    int** puzzle = allocatePuzzle();
-    readInput("Ass1Input.txt", puzzle);
+        // --- Test buildEdgeTable / decodePuzzle
+        Tile input_tiles[TILES_IN_PUZZLE_COUNT];
+        readInput("Ass1Input.txt", input_tiles);
+        EdgeTable edge_table = buildEdgeTable(input_tiles);
 
-    // second copy for comparison
-    int copy_puzzle[TILES_IN_PUZZLE_COUNT][TILE_SIZE];
-    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
-        for (int j = 0; j < TILE_SIZE; j++){
-            copy_puzzle[i][j] = puzzle[i][j];
+        Puzzle puzzle = allocatePuzzle();
+        writeInputOrder(puzzle);
+
+        Tile decoded[TILES_IN_PUZZLE_COUNT];
+        decodePuzzle(puzzle, edge_table, decoded);
+        for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+            assert(decoded[i] == input_tiles[i]);
+        }
+
+        for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+            Gene gene = makeGene(i, 0);
+            Tile tile = input_tiles[i];
+            for (int r = 0; r < TILE_SIZE; r++){
+                for (int e = 0; e < TILE_SIZE; e++){
+                    assert(getGeneEdge(edge_table, gene, e) == getEdge(tile, e));
+                }
+                rotateGene(gene);
+                rotateToLeftByOneIndex(tile);
+            }
+            assert(gene == makeGene(i, 0));
         }
-    }
 
-    swapTile(puzzle);
+        // the input arrangement scored through the edge table matches a direct count on the tiles
+        int expected_mismatch = 0;
+        for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+            if (i % PUZZLE_WIDTH != 0 && getEdge(input_tiles[i], LEFT) != getEdge(input_tiles[i-1], RIGHT)){
+                expected_mismatch++;
+            }
+            if (i >= PUZZLE_WIDTH && getEdge(input_tiles[i], TOP) != getEdge(input_tiles[i-PUZZLE_WIDTH], BOTTOM)){
+                expected_mismatch++;
+            }
+        }
+        assert(countEdgeMismatch(puzzle, edge_table) == expected_mismatch);
+        // -------------------------------
 
-    // checking if swaps happened properly
-    int swap_count = 0;
-    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
-        if (!assertArrayEqual(puzzle[i], copy_puzzle[i])){
-            swap_count++;
+        // --- Test motif characters and readInput rejecting files of another geometry
+        for (int motif = 0; motif < 36; motif++){
+            assert(charToMotif(motifToChar(motif)) == motif);
         }
-    }
-    assert(swap_count == 2);
-    // -------------------------------
-    
+        assert(motifToChar(9) == '9' && motifToChar(10) == 'a');
+        assert(charToMotif('-') == -1);
+
+        {
+            ofstream wrong_shape("wrong-shape.txt");
+            for (int row = 0; row < PUZZLE_HEIGHT - 1; row++){
+                for (int col = 0; col < PUZZLE_WIDTH; col++){
+                    wrong_shape << "0000 ";
+                }
+                wrong_shape << "\n";
+            }
+        }
+        int shape_width, shape_height, shape_motif_count;
+        readInputShape("wrong-shape.txt", shape_width, shape_height, shape_motif_count);
+        assert(shape_width == PUZZLE_WIDTH && shape_height == PUZZLE_HEIGHT - 1 && shape_motif_count == 1);
+        Tile wrong_tiles[TILES_IN_PUZZLE_COUNT];
+        bool rejected = false;
+        try {
+            readInput("wrong-shape.txt", wrong_tiles);
+        } catch (const runtime_error &error) {
+            rejected = string(error.what()).find("is not a " + to_string(PUZZLE_WIDTH) + "x" + to_string(PUZZLE_HEIGHT) + " puzzle") != string::npos;
+        }
+        assert(rejected);
+        remove("wrong-shape.txt");
+        // ---
+
+        // --- Test buildTileClassTable
+        TileClassTable tile_class_table = buildTileClassTable(input_tiles);
+        int tiles_counted = 0;
+        for (int c = 0; c < tile_class_table.class_count; c++){
+            tiles_counted += tile_class_table.multiplicity[c];
+        }
+        assert(tiles_counted == TILES_IN_PUZZLE_COUNT);
+
+        for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+            Tile tile = input_tiles[i];
+            for (int r = 0; r < TILE_SIZE; r++){
+                assert(tile_class_table.canonical_id[encodeTileIndex(tile)] == tile_class_table.tile_class[i]);
+                rotateToLeftByOneIndex(tile);
+            }
+        }
+        assert(hasInputTileCounts(decoded, tile_class_table));
 
-    // --- Test generatePopulation
-    readInput("Ass1Input.txt", puzzle);
-    int POPULATION_SIZE = 1000;
-    //int population_arr[POPULATION_SIZE][TILES_IN_PUZZLE_COUNT][TILE_SIZE];
-    int*** population_arr = allocatePopulation(POPULATION_SIZE);
-    generatePopulation(population_arr, puzzle, POPULATION_SIZE);
-
-    swap_count = 0;
-    for (int i = 1; i < POPULATION_SIZE; i++){
-        for (int j = 0; j < TILES_IN_PUZZLE_COUNT; j++){
-            if (!assertArrayEqual(population_arr[0][j], population_arr[i][j])){
+        // a duplicated tile breaks the counts
+        Tile bad_tiles[TILES_IN_PUZZLE_COUNT];
+        for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+            bad_tiles[i] = input_tiles[i];
+        }
+        int unique_tile = 0;
+        while (tile_class_table.multiplicity[tile_class_table.tile_class[unique_tile]] != 1){
+            unique_tile++;
+        }
+        bad_tiles[(unique_tile + 1) % TILES_IN_PUZZLE_COUNT] = rotateTile(bad_tiles[unique_tile]);
+        assert(!hasInputTileCounts(bad_tiles, tile_class_table));
+        // -------------------------------
+
+        // --- Test makeRng / randomBelow
+        Rng rng = makeRng(12345, 0);
+        Rng same_stream = makeRng(12345, 0);
+        Rng other_stream = makeRng(12345, 1);
+        Rng other_seed = makeRng(12346, 0);
+        int other_stream_matches = 0;
+        int other_seed_matches = 0;
+        for (int i = 0; i < 1000; i++){
+            uint64_t value = nextRandom(rng);
+            assert(value == nextRandom(same_stream));
+            other_stream_matches += value == nextRandom(other_stream);
+            other_seed_matches += value == nextRandom(other_seed);
+        }
+        assert(other_stream_matches == 0);
+        assert(other_seed_matches == 0);
+
+        int bucket_counts[7] = {0};
+        for (int i = 0; i < 70000; i++){
+            int value = randomBelow(rng, 7);
+            assert(value >= 0 && value < 7);
+            bucket_counts[value]++;
+        }
+        for (int i = 0; i < 7; i++){
+            assert(bucket_counts[i] > 9000 && bucket_counts[i] < 11000);
+        }
+        // -------------------------------
+
+        // --- Test swapTile
+
+        // second copy for comparison
+        Gene copy_puzzle[TILES_IN_PUZZLE_COUNT];
+        for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+            copy_puzzle[i] = puzzle[i];
+        }
+
+        swapTile(puzzle, rng);
+
+        // checking if swaps happened properly
+        int swap_count = 0;
+        for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+            if (puzzle[i] != copy_puzzle[i]){
                 swap_count++;
             }
         }
-        assert(swap_count >= 20);
+        assert(swap_count == 2);
+        assert(isPermutation(puzzle));
+        // -------------------------------
+    
+
+        // --- Test generatePopulation
+        writeInputOrder(puzzle);
+        int POPULATION_SIZE = 1000;
+        //int population_arr[POPULATION_SIZE][TILES_IN_PUZZLE_COUNT][TILE_SIZE];
+        Population population_arr = allocatePopulation(POPULATION_SIZE);
+        generatePopulation(population_arr, puzzle, POPULATION_SIZE, rng);
+
+        // --- Test allocatePopulation layout
+        for (int i = 0; i < POPULATION_SIZE; i++){
+            assert(reinterpret_cast<uintptr_t>(population_arr[i]) % CACHE_LINE_SIZE == 0);
+        }
+        assert((char*)population_arr[1] - (char*)population_arr[0] == population_arr.stride * (int)sizeof(Gene));
+        assert(population_arr.stride * sizeof(Gene) == CACHE_LINE_SIZE);
+        // ----
+
         swap_count = 0;
-    }
-    // ----
+        for (int i = 1; i < POPULATION_SIZE; i++){
+            for (int j = 0; j < TILES_IN_PUZZLE_COUNT; j++){
+                if (population_arr[0][j] != population_arr[i][j]){
+                    swap_count++;
+                }
+            }
+            assert(swap_count >= 20);
+            assert(isPermutation(population_arr[i]));
+            swap_count = 0;
+        }
+        // ----
 
-    // --- Test countEdgeMismatch
-    auto start = chrono::high_resolution_clock::now();
-    for (int i = 0; i < POPULATION_SIZE; i++){
-        countEdgeMismatch(population_arr[i]);
-    }
+        // --- Test generatePopulation is deterministic for a seed (and thread count)
+        Population replay_arr = allocatePopulation(POPULATION_SIZE);
+        Rng replay_rng = makeRng(99, 0);
+        generatePopulation(population_arr, puzzle, POPULATION_SIZE, replay_rng);
+        replay_rng = makeRng(99, 0);
+        generatePopulation(replay_arr, puzzle, POPULATION_SIZE, replay_rng);
+        for (int i = 0; i < POPULATION_SIZE; i++){
+            assert(memcmp(population_arr[i], replay_arr[i], TILES_IN_PUZZLE_COUNT * sizeof(Gene)) == 0);
+            assert(population_arr.dirty[i]);
+        }
+        freePopulation(replay_arr);
+        // ----
+
+        // --- Test buildCandidateIndex / generateGreedyPopulation
+        CandidateIndex candidate_index = buildCandidateIndex(edge_table);
+        assert(candidate_index.start[MOTIF_COUNT * MOTIF_COUNT] == TILES_IN_PUZZLE_COUNT * TILE_SIZE);
+        vector<bool> indexed(TILES_IN_PUZZLE_COUNT * TILE_SIZE, false);
+        for (int top = 0; top < MOTIF_COUNT; top++){
+            for (int left = 0; left < MOTIF_COUNT; left++){
+                int group = top * MOTIF_COUNT + left;
+                for (int k = candidate_index.start[group]; k < candidate_index.start[group + 1]; k++){
+                    Gene gene = candidate_index.genes[k];
+                    assert(getGeneEdge(edge_table, gene, TOP) == top && getGeneEdge(edge_table, gene, LEFT) == left);
+                    assert(!indexed[gene]);
+                    indexed[gene] = true;
+                }
+            }
+        }
+
+        Population greedy_arr = allocatePopulation(POPULATION_SIZE);
+        Population greedy_replay_arr = allocatePopulation(POPULATION_SIZE);
+        replay_rng = makeRng(99, 0);
+        generateGreedyPopulation(greedy_arr, POPULATION_SIZE, edge_table, replay_rng);
+        replay_rng = makeRng(99, 0);
+        generateGreedyPopulation(greedy_replay_arr, POPULATION_SIZE, edge_table, replay_rng);
+        refreshFitness(greedy_arr, POPULATION_SIZE, edge_table);
+        refreshFitness(population_arr, POPULATION_SIZE, edge_table);
+        double greedy_mean = 0;
+        double random_mean = 0;
+        for (int i = 0; i < POPULATION_SIZE; i++){
+            assert(isPermutation(greedy_arr[i]));
+            assert(memcmp(greedy_arr[i], greedy_replay_arr[i], TILES_IN_PUZZLE_COUNT * sizeof(Gene)) == 0);
+            greedy_mean += (double)greedy_arr.fitness[i] / POPULATION_SIZE;
+            random_mean += (double)population_arr.fitness[i] / POPULATION_SIZE;
+        }
+        // the constructed individuals differ from each other and start far below the random baseline
+        assert(memcmp(greedy_arr[0], greedy_arr[1], TILES_IN_PUZZLE_COUNT * sizeof(Gene)) != 0);
+        assert(greedy_mean < random_mean / 2);
+        cout << "Mean initial edge mismatch: random " << random_mean << ", greedy " << greedy_mean << endl;
+        freePopulation(greedy_arr);
+        freePopulation(greedy_replay_arr);
+        // ----
 
-    auto end = chrono::high_resolution_clock::now();
-    chrono::duration<double> elapsed = end - start;
+        // --- Test countEdgeMismatch
+        auto start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < POPULATION_SIZE; i++){
+            countEdgeMismatch(population_arr[i], edge_table);
+        }
+
+        auto end = chrono::high_resolution_clock::now();
+        chrono::duration<double> elapsed = end - start;
 
-    cout << "\nTime taken to count edge mismatches in " << POPULATION_SIZE << "puzzles: " << elapsed.count() << \
-    " seconds \n---> " << elapsed.count()/POPULATION_SIZE << " s/puzzle" << endl;
+        cout << "\nTime taken to count edge mismatches in " << POPULATION_SIZE << "puzzles: " << elapsed.count() << \
+        " seconds \n---> " << elapsed.count()/POPULATION_SIZE << " s/puzzle" << \
+        "\n---> " << POPULATION_SIZE/elapsed.count() << " evaluations/s" << endl;
 
-    // --- Test OnePointCrossover
-    int** parent1 = population_arr[0];
-    int** parent2 = population_arr[1];
+        // --- Test evaluateFitnessBatch
+        vector<int> batch_fitness(POPULATION_SIZE, -1);
+        const int BATCH_REPEATS = 100;
+        start = chrono::high_resolution_clock::now();
+        for (int repeat = 0; repeat < BATCH_REPEATS; repeat++){
+            evaluateFitnessBatch(population_arr, 0, POPULATION_SIZE, edge_table, batch_fitness.data());
+        }
+        end = chrono::high_resolution_clock::now();
+        elapsed = end - start;
 
-    int initialParent1[TILES_IN_PUZZLE_COUNT][TILE_SIZE];
-    int initialParent2[TILES_IN_PUZZLE_COUNT][TILE_SIZE];
+        cout << "Time taken to batch evaluate " << POPULATION_SIZE << " puzzles: " << elapsed.count()/BATCH_REPEATS << \
+        " seconds \n---> " << (double)POPULATION_SIZE * BATCH_REPEATS/elapsed.count() << " evaluations/s" << endl;
 
-    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++) {
-        for (int j = 0; j < TILE_SIZE; j++) {
-            initialParent1[i][j] = parent1[i][j];
-            initialParent2[i][j] = parent2[i][j];
+        for (int i = 0; i < POPULATION_SIZE; i++){
+            assert(batch_fitness[i] == countEdgeMismatchScalar(population_arr[i], edge_table));
+        }
+
+        // a range that does not start or end on a multiple of 8 leaves the rest untouched
+        fill(batch_fitness.begin(), batch_fitness.end(), -1);
+        evaluateFitnessBatch(population_arr, 3, 30, edge_table, batch_fitness.data());
+        for (int i = 0; i < POPULATION_SIZE; i++){
+            if (i < 3 || i >= 30){
+                assert(batch_fitness[i] == -1);
+            }
+            else{
+                assert(batch_fitness[i] == countEdgeMismatchScalar(population_arr[i], edge_table));
+            }
         }
-    }
 
-    int crossoverPoint = onePointCrossover(parent1, parent2);
+        // --- Test countEdgeMismatchAVX2 against the scalar kernel
+        if (hasAVX2()){
+            for (int i = 0; i < POPULATION_SIZE; i++){
+                assert(countEdgeMismatchAVX2(population_arr[i], edge_table) == countEdgeMismatchScalar(population_arr[i], edge_table));
+            }
 
-    // Verify the crossover operation
-    for (int i = 0; i < crossoverPoint; i++) {
-        for (int j = 0; j < TILE_SIZE; j++) {
-            assert(assertArrayEqual(parent1[i], initialParent1[i]));
-            assert(assertArrayEqual(parent2[i], initialParent2[i]));
+            // every position with every rotation, including the first column and row
+            Gene rotated[TILES_IN_PUZZLE_COUNT];
+            copyPuzzle(population_arr[0], rotated);
+            for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+                for (int r = 0; r < TILE_SIZE; r++){
+                    rotateGene(rotated[i]);
+                    assert(countEdgeMismatchAVX2(rotated, edge_table) == countEdgeMismatchScalar(rotated, edge_table));
+                }
+            }
+            cout << "AVX2 edge mismatch kernel matches the scalar kernel" << endl;
         }
-    }
+        else{
+            cout << "AVX2 not supported, skipping AVX2 kernel check" << endl;
+        }
+        assert(countEdgeMismatch(population_arr[0], edge_table) == countEdgeMismatchScalar(population_arr[0], edge_table));
+
+        // --- Test OnePointCrossover
+        Puzzle parent1 = population_arr[0];
+        Puzzle parent2 = population_arr[1];
+
+        Gene initialParent1[TILES_IN_PUZZLE_COUNT];
+        Gene initialParent2[TILES_IN_PUZZLE_COUNT];
 
-    for (int i = crossoverPoint; i < TILES_IN_PUZZLE_COUNT; i++) {
-        for (int j = 0; j < TILE_SIZE; j++) {
-            assert(assertArrayEqual(parent1[i], initialParent2[i]));
-            assert(assertArrayEqual(parent2[i], initialParent1[i]));
+        for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++) {
+            initialParent1[i] = parent1[i];
+            initialParent2[i] = parent2[i];
+        }
+
+        int crossoverPoint = onePointCrossover(parent1, parent2, rng);
+
+        // Verify the crossover operation
+        for (int i = 0; i < crossoverPoint; i++) {
+            for (int j = 0; j < TILE_SIZE; j++) {
+                assert(parent1[i] == initialParent1[i]);
+                assert(parent2[i] == initialParent2[i]);
+            }
+        }
+
+        for (int i = crossoverPoint; i < TILES_IN_PUZZLE_COUNT; i++) {
+            for (int j = 0; j < TILE_SIZE; j++) {
+                assert(parent1[i] == initialParent2[i]);
+                assert(parent2[i] == initialParent1[i]);
+            }
         }
-    }
 
-    // --- Test TwoPointCrossover
-    int** parent3 = population_arr[2];
-    int** parent4 = population_arr[3];
+        // --- Test TwoPointCrossover
+        Puzzle parent3 = population_arr[2];
+        Puzzle parent4 = population_arr[3];
    
-   // Capture the initial state of parent3 and parent4
-    int initialParent3[TILES_IN_PUZZLE_COUNT][TILE_SIZE];
-    int initialParent4[TILES_IN_PUZZLE_COUNT][TILE_SIZE];
-    for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++) {
-        for (int j = 0; j < TILE_SIZE; j++) {
-            initialParent3[i][j] = parent3[i][j];
-            initialParent4[i][j] = parent4[i][j];
+       // Capture the initial state of parent3 and parent4
+        Gene initialParent3[TILES_IN_PUZZLE_COUNT];
+        Gene initialParent4[TILES_IN_PUZZLE_COUNT];
+        for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++) {
+            initialParent3[i] = parent3[i];
+            initialParent4[i] = parent4[i];
+        }
+        pair<int, int> crossoverPoints = twoPointCrossover(parent3, parent4, rng);
+        int point1 = crossoverPoints.first;
+        int point2 = crossoverPoints.second;
+
+        // Verify the crossover operation
+        for (int i = 0; i < point1; i++) {
+            assert(parent3[i] == initialParent3[i]);
+            assert(parent4[i] == initialParent4[i]);
+        }
+
+        for (int i = point1; i <= point2; i++) {
+            assert(parent3[i] == initialParent4[i]);
+            assert(parent4[i] == initialParent3[i]);
+        }
+
+        for (int i = point2 + 1; i < TILES_IN_PUZZLE_COUNT; i++) {
+            assert(parent3[i] == initialParent3[i]);
+            assert(parent4[i] == initialParent4[i]);
+        }
+
+        // ---
+
+        // --- Test orderCrossover
+        for (int trial = 0; trial < 100; trial++){
+            Puzzle offspring1 = population_arr[4 + 2 * trial];
+            Puzzle offspring2 = population_arr[5 + 2 * trial];
+            orderCrossover(offspring1, offspring2, rng);
+            assert(isPermutation(offspring1));
+            assert(isPermutation(offspring2));
+
+            decodePuzzle(offspring1, edge_table, decoded);
+            assert(hasInputTileCounts(decoded, tile_class_table));
+        }
+        // ---
+
+        // --- Test swapTileDelta / rotateGeneDelta
+        Puzzle delta_puzzle = population_arr[POPULATION_SIZE - 1];
+        int tracked_fitness = countEdgeMismatch(delta_puzzle, edge_table);
+        for (int trial = 0; trial < 1000; trial++){
+            int first_index = randomTileIndex(rng);
+            int second_index = randomTileIndex(rng);
+            // bias towards adjacent swaps, whose shared edge must only be counted once
+            if (trial % 3 == 0 && first_index % 8 != 7){
+                second_index = first_index + 1;
+            } else if (trial % 3 == 1 && first_index < 56){
+                second_index = first_index + 8;
+            }
+            if (first_index != second_index){
+                tracked_fitness += swapTileDelta(delta_puzzle, first_index, second_index, edge_table);
+                assert(tracked_fitness == countEdgeMismatch(delta_puzzle, edge_table));
+            }
+            tracked_fitness += rotateGeneDelta(delta_puzzle, randomTileIndex(rng), edge_table);
+            assert(tracked_fitness == countEdgeMismatch(delta_puzzle, edge_table));
+        }
+        assert(isPermutation(delta_puzzle));
+        // ---
+
+        // --- Test refreshFitness only rescores dirty individuals
+        generatePopulation(population_arr, puzzle, POPULATION_SIZE, rng);
+        assert(refreshFitness(population_arr, POPULATION_SIZE, edge_table) == POPULATION_SIZE);
+        assert(refreshFitness(population_arr, POPULATION_SIZE, edge_table) == 0);
+        population_arr.dirty[0] = true;
+        population_arr.dirty[9] = true;
+        population_arr.dirty[10] = true;
+        population_arr.fitness[9] = -1;
+        assert(refreshFitness(population_arr, POPULATION_SIZE, edge_table) == 3);
+        for (int i = 0; i < POPULATION_SIZE; i++){
+            assert(!population_arr.dirty[i]);
+            assert(population_arr.fitness[i] == countEdgeMismatch(population_arr[i], edge_table));
+        }
+        // ---
+
+        // --- Test mutate keeps the cached fitness exact or marks it dirty
+        mutate(population_arr, POPULATION_SIZE, edge_table, rng, 32);
+        int dirty_count = 0;
+        for (int i = 0; i < POPULATION_SIZE; i++){
+            if (population_arr.dirty[i]){
+                dirty_count++;
+            } else {
+                assert(population_arr.fitness[i] == countEdgeMismatch(population_arr[i], edge_table));
+            }
+        }
+        assert(dirty_count > 0 && dirty_count < POPULATION_SIZE);
+        assert(refreshFitness(population_arr, POPULATION_SIZE, edge_table) == dirty_count);
+        for (int i = 0; i < POPULATION_SIZE; i++){
+            assert(population_arr.fitness[i] == countEdgeMismatch(population_arr[i], edge_table));
+        }
+        // ---
+
+        // --- Test crossover builds offspring in their destination slots and leaves the parents alone
+        vector<int> crossover_parents = {10, 11, 12, 13};
+        vector<int> crossover_destinations = {20, 21, 22, 23};
+        Gene parent_before[4][TILES_IN_PUZZLE_COUNT];
+        for (int k = 0; k < 4; k++){
+            copyPuzzle(population_arr[crossover_parents[k]], parent_before[k]);
+        }
+        // without recombination every offspring is a copy of its parent, fitness included
+        crossover(population_arr, POPULATION_SIZE, crossover_parents, crossover_destinations, MAX_EDGE_MISMATCH_COUNT, rng);
+        for (int k = 0; k < 4; k++){
+            assert(memcmp(population_arr[crossover_parents[k]], parent_before[k], TILES_IN_PUZZLE_COUNT) == 0);
+            assert(memcmp(population_arr[crossover_destinations[k]], parent_before[k], TILES_IN_PUZZLE_COUNT) == 0);
+            assert(population_arr.fitness[crossover_destinations[k]] == population_arr.fitness[crossover_parents[k]]);
+        }
+        crossover(population_arr, POPULATION_SIZE, crossover_parents, crossover_destinations, 0, rng);
+        mutate(population_arr, crossover_destinations, edge_table, rng, 32);
+        for (int k = 0; k < 4; k++){
+            assert(memcmp(population_arr[crossover_parents[k]], parent_before[k], TILES_IN_PUZZLE_COUNT) == 0);
+            assert(isPermutation(population_arr[crossover_destinations[k]]));
+            assert(population_arr.dirty[crossover_destinations[k]]);
+        }
+        refreshFitness(population_arr, POPULATION_SIZE, edge_table);
+        // ---
+
+        // --- Test bestRotationDelta picks the best rotation and repairRotations reaches a fixpoint
+        {
+            Gene turned[TILES_IN_PUZZLE_COUNT];
+            copyPuzzle(population_arr[31], turned);
+            for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+                int before = countEdgeMismatch(turned, edge_table);
+                int best_delta = 0;
+                int rotation_delta = 0;
+                for (int r = 1; r < TILE_SIZE; r++){
+                    rotation_delta += rotateGeneDelta(turned, i, edge_table);
+                    best_delta = min(best_delta, rotation_delta);
+                }
+                rotateGene(turned[i]);
+                Gene original = turned[i];
+
+                int delta = bestRotationDelta(turned, i, edge_table);
+                assert(delta == best_delta);
+                assert(getGeneTile(turned[i]) == getGeneTile(original));
+                assert(delta < 0 || turned[i] == original);
+                assert(countEdgeMismatch(turned, edge_table) == before + delta);
+            }
+
+            // mutate already repairs its offspring, so scramble the rotations first
+            for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+                turned[i] = makeGene(getGeneTile(population_arr[31][i]), randomBelow(rng, TILE_SIZE));
+            }
+            int before = countEdgeMismatch(turned, edge_table);
+            int delta = repairRotations(turned, edge_table);
+            assert(delta < 0);
+            assert(countEdgeMismatch(turned, edge_table) == before + delta);
+            for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+                assert(getGeneTile(turned[i]) == getGeneTile(population_arr[31][i]));
+                assert(bestRotationDelta(turned, i, edge_table) == 0);
+            }
+            assert(repairRotations(turned, edge_table) == 0);
+        }
+        // ---
+
+        // --- Test hillClimb ends in a local optimum and localSearch keeps the cached fitness exact
+        for (LocalSearchMethod method : {FIRST_IMPROVEMENT_LOCAL_SEARCH, BEST_IMPROVEMENT_LOCAL_SEARCH}){
+            Gene climbed[TILES_IN_PUZZLE_COUNT];
+            copyPuzzle(population_arr[30], climbed);
+            assert(hillClimb(climbed, edge_table, method, 0, INT_MAX) == 0);
+            assert(memcmp(climbed, population_arr[30], TILES_IN_PUZZLE_COUNT) == 0);
+
+            int before = countEdgeMismatch(climbed, edge_table);
+            int delta = hillClimb(climbed, edge_table, method, INT_MAX, INT_MAX);
+            assert(delta < 0);
+            assert(countEdgeMismatch(climbed, edge_table) == before + delta);
+            assert(isPermutation(climbed));
+            for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+                int rotation_delta = 0;
+                for (int r = 1; r < TILE_SIZE; r++){
+                    rotation_delta += rotateGeneDelta(climbed, i, edge_table);
+                    assert(rotation_delta >= 0);
+                }
+                rotateGene(climbed[i]);
+                for (int j = i + 1; j < TILES_IN_PUZZLE_COUNT; j++){
+                    assert(swapTileDelta(climbed, i, j, edge_table) >= 0);
+                    swapTileDelta(climbed, i, j, edge_table);
+                }
+            }
+            assert(countEdgeMismatch(climbed, edge_table) == before + delta);
+        }
+        assert(hillClimb(population_arr[30], edge_table, NO_LOCAL_SEARCH, INT_MAX, INT_MAX) == 0);
+
+        mutate(population_arr, crossover_destinations, edge_table, rng, 32);
+        localSearch(population_arr, crossover_destinations, edge_table, BEST_IMPROVEMENT_LOCAL_SEARCH);
+        for (int k = 0; k < 4; k++){
+            int i = crossover_destinations[k];
+            assert(isPermutation(population_arr[i]));
+            assert(population_arr.dirty[i] || population_arr.fitness[i] == countEdgeMismatch(population_arr[i], edge_table));
+        }
+        refreshFitness(population_arr, POPULATION_SIZE, edge_table);
+        // ---
+
+        // --- Test solveExact finds a solution, the same one when split into tasks, and proves unsolvable inputs
+        {
+            Gene exact_solution[TILES_IN_PUZZLE_COUNT];
+            Gene split_solution[TILES_IN_PUZZLE_COUNT];
+            long long exact_nodes, split_nodes;
+            start = chrono::high_resolution_clock::now();
+            assert(solveExact(exact_solution, edge_table, LLONG_MAX, exact_nodes));
+            end = chrono::high_resolution_clock::now();
+            elapsed = end - start;
+            assert(countEdgeMismatch(exact_solution, edge_table) == 0);
+            assert(isPermutation(exact_solution));
+            Tile exact_tiles[TILES_IN_PUZZLE_COUNT];
+            decodePuzzle(exact_solution, edge_table, exact_tiles);
+            assert(hasInputTileCounts(exact_tiles, tile_class_table));
+            cout << "Exact solution after " << exact_nodes << " nodes in " << elapsed.count() << " s" << endl;
+
+            assert(solveExact(split_solution, edge_table, LLONG_MAX, split_nodes, EXACT_SPLIT_DEPTH));
+            assert(memcmp(exact_solution, split_solution, sizeof(exact_solution)) == 0);
+
+            assert(!solveExact(split_solution, edge_table, 100, split_nodes));
+            assert(split_nodes >= 100);
+
+            // a single tile whose motif appears nowhere else can only go in a corner, and still mismatches twice
+            const int zero_edges[TILE_SIZE] = {0, 0, 0, 0};
+            const int one_edges[TILE_SIZE] = {1, 1, 1, 1};
+            Tile unsolvable_tiles[TILES_IN_PUZZLE_COUNT];
+            fill(unsolvable_tiles, unsolvable_tiles + TILES_IN_PUZZLE_COUNT, packTile(zero_edges));
+            unsolvable_tiles[TILES_IN_PUZZLE_COUNT / 2] = packTile(one_edges);
+            EdgeTable unsolvable_table = buildEdgeTable(unsolvable_tiles);
+            assert(!solveExact(split_solution, unsolvable_table, LLONG_MAX, split_nodes, EXACT_SPLIT_DEPTH));
+            assert(split_nodes < TILES_IN_PUZZLE_COUNT * TILES_IN_PUZZLE_COUNT);
+        }
+        // ---
+
+        // --- Test completeExact repairs a near-solved puzzle and leaves it alone when the budget runs out
+        {
+            Gene near_solved[TILES_IN_PUZZLE_COUNT];
+            long long completion_nodes;
+            assert(solveExact(near_solved, edge_table, LLONG_MAX, completion_nodes));
+            swap(near_solved[9], near_solved[TILES_IN_PUZZLE_COUNT - 10]);
+            rotateGene(near_solved[PUZZLE_WIDTH * 3 + 4]);
+            assert(countEdgeMismatch(near_solved, edge_table) > 0);
+            bool frozen[TILES_IN_PUZZLE_COUNT];
+            Gene before_completion[TILES_IN_PUZZLE_COUNT];
+            copyPuzzle(near_solved, before_completion);
+            for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+                frozen[i] = countLocalEdgeMismatch(near_solved, i, edge_table) == 0;
+            }
+            // the region around the three moved tiles has a completion, so no frozen tile moves
+            assert(completeExact(near_solved, edge_table, EXACT_COMPLETION_NODE_LIMIT, completion_nodes));
+            assert(countEdgeMismatch(near_solved, edge_table) == 0);
+            assert(isPermutation(near_solved));
+            for (int i = 0; i < TILES_IN_PUZZLE_COUNT; i++){
+                assert(!frozen[i] || near_solved[i] == before_completion[i]);
+            }
+
+            Gene scrambled[TILES_IN_PUZZLE_COUNT];
+            copyPuzzle(population_arr[5], scrambled);
+            assert(!completeExact(scrambled, edge_table, 1, completion_nodes));
+            assert(memcmp(scrambled, population_arr[5], sizeof(scrambled)) == 0);
+
+            // the greedy population starts close enough for the engines to finish it exactly
+            const int COMPLETION_POPULATION_SIZE = 200;
+            Population completion_arr = allocatePopulation(COMPLETION_POPULATION_SIZE);
+            Puzzle completion_best = allocatePuzzle();
+            Rng completion_rng = makeRng(11, 0);
+            generateGreedyPopulation(completion_arr, COMPLETION_POPULATION_SIZE, edge_table, completion_rng);
+            assert(evolveSteadyState(completion_arr, 2000, COMPLETION_POPULATION_SIZE, edge_table, completion_rng, false, completion_best, NO_LOCAL_SEARCH, EXACT_COMPLETION_NODE_LIMIT) == 0);
+            assert(countEdgeMismatch(completion_best, edge_table) == 0);
+            assert(isPermutation(completion_best));
+            freePuzzle(completion_best);
+            freePopulation(completion_arr);
+        }
+        // ---
+
+        // --- Test coolingTemperature / anneal
+        for (CoolingSchedule schedule : {GEOMETRIC_COOLING, LINEAR_COOLING, LUNDY_MEES_COOLING}){
+            assert(fabs(coolingTemperature(schedule, 2.0, 0.1, 0) - 2.0) < 1e-9);
+            assert(fabs(coolingTemperature(schedule, 2.0, 0.1, 1) - 0.1) < 1e-9);
+            for (int k = 1; k <= 10; k++){
+                assert(coolingTemperature(schedule, 2.0, 0.1, k / 10.0) < coolingTemperature(schedule, 2.0, 0.1, (k - 1) / 10.0));
+            }
+        }
+        // Lundy-Mees cools fastest while hot, linear slowest
+        assert(coolingTemperature(LUNDY_MEES_COOLING, 2.0, 0.1, 0.5) < coolingTemperature(GEOMETRIC_COOLING, 2.0, 0.1, 0.5));
+        assert(coolingTemperature(GEOMETRIC_COOLING, 2.0, 0.1, 0.5) < coolingTemperature(LINEAR_COOLING, 2.0, 0.1, 0.5));
+        {
+            AnnealingSettings tempering_settings = makeAnnealingSettings();
+            tempering_settings.replica_count = 3;
+            tempering_settings.reheat_interval = 50;
+            Puzzle annealed = allocatePuzzle();
+            Puzzle annealed_replay = allocatePuzzle();
+            Rng annealing_rng = makeRng(21, 0);
+            int annealed_best = anneal(puzzle, 500, 400, edge_table, annealing_rng, false, annealed, tempering_settings, GREEDY_INITIALIZATION);
+            assert(annealed_best == countEdgeMismatch(annealed, edge_table));
+            assert(isPermutation(annealed));
+#ifdef _OPENMP
+            // the replicas have their own streams, so the thread count does not change the run
+            int thread_count = omp_get_max_threads();
+            omp_set_num_threads(thread_count == 1 ? 2 : 1);
+#endif
+            annealing_rng = makeRng(21, 0);
+            assert(anneal(puzzle, 500, 400, edge_table, annealing_rng, false, annealed_replay, tempering_settings, GREEDY_INITIALIZATION) == annealed_best);
+            assert(memcmp(annealed, annealed_replay, TILES_IN_PUZZLE_COUNT * sizeof(Gene)) == 0);
+#ifdef _OPENMP
+            omp_set_num_threads(thread_count);
+#endif
+            freePuzzle(annealed);
+            freePuzzle(annealed_replay);
+        }
+        // ---
+
+        // --- Test evaluateFitness
+        vector<pair<int, int>> fitness_results;
+        evaluateFitness(population_arr, POPULATION_SIZE, 250, fitness_results);
+        assert(fitness_results.size() == POPULATION_SIZE);
+
+        // checking if sorted properly, with ties kept in index order
+        for (int i = 1; i < fitness_results.size(); i++) {
+            assert(fitness_results[i-1].second >= fitness_results[i].second);
+            if (fitness_results[i-1].second == fitness_results[i].second){
+                assert(fitness_results[i-1].first < fitness_results[i].first);
+            }
+        }
+        vector<bool> ranked(POPULATION_SIZE, false);
+        for (int i = 0; i < fitness_results.size(); i++) {
+            assert(fitness_results[i].second == population_arr.fitness[fitness_results[i].first]);
+            assert(!ranked[fitness_results[i].first]);
+            ranked[fitness_results[i].first] = true;
+        }
+        // ---
+
+        // --- Test rankByFitnessPartial (taken when a fitness is outside the counting sort range)
+        population_arr.fitness[17] = 1000;
+        evaluateFitness(population_arr, POPULATION_SIZE, 250, fitness_results);
+        vector<int> fitness_sorted(population_arr.fitness, population_arr.fitness + POPULATION_SIZE);
+        sort(fitness_sorted.rbegin(), fitness_sorted.rend());
+        bool outlier_in_worst = false;
+        for (int i = 0; i < 250; i++) {
+            outlier_in_worst = outlier_in_worst || fitness_results[i].first == 17;
+            assert(fitness_results[i].second >= fitness_sorted[249]);
+            assert(fitness_results[POPULATION_SIZE - 1 - i].second <= fitness_sorted[POPULATION_SIZE - 250]);
+        }
+        assert(outlier_in_worst);
+        assert(fitness_results.back().second == fitness_sorted.back());
+        population_arr.fitness[17] = countEdgeMismatch(population_arr[17], edge_table);
+
+        // --- Test runWorkStealing runs every task exactly once, even with uneven costs
+        const int STEALING_TASK_COUNT = 1000;
+        vector<atomic<int>> task_runs(STEALING_TASK_COUNT);
+        for (int i = 0; i < STEALING_TASK_COUNT; i++){
+            task_runs[i].store(0);
+        }
+        runWorkStealing(STEALING_TASK_COUNT, [](int task_index, void* context){
+            vector<atomic<int>> &runs = *static_cast<vector<atomic<int>>*>(context);
+            // the first tasks are much more expensive, so the first thread's block needs stealing
+            volatile int sink = 0;
+            for (int k = 0; k < (task_index < 100 ? 100000 : 10); k++){
+                sink = sink ^ k;
+            }
+            runs[task_index].fetch_add(1);
+        }, &task_runs);
+        for (int i = 0; i < STEALING_TASK_COUNT; i++){
+            assert(task_runs[i].load() == 1);
+        }
+        assert(runWorkStealing(0, [](int, void*){ assert(false); }, nullptr) == 0);
+        // ---
+
+        // --- Test steady-state generations make no heap allocations
+#ifdef EVOL_PUZZLE_COUNT_ALLOCATIONS
+        {
+            const int STEADY_OFFSPRING_SIZE = POPULATION_SIZE / 4;
+            Population steady_arr = allocatePopulation(POPULATION_SIZE);
+            vector<pair<int, int>> steady_ranking;
+            vector<int> steady_parents;
+            vector<int> steady_worst;
+            generatePopulation(steady_arr, puzzle, POPULATION_SIZE, rng);
+
+            // the first generation sizes the reused buffers
+            for (int generation = 0; generation < 11; generation++){
+                long long allocation_count = getAllocationCount();
+                refreshFitness(steady_arr, POPULATION_SIZE, edge_table);
+                evaluateFitness(steady_arr, POPULATION_SIZE, STEADY_OFFSPRING_SIZE, steady_ranking);
+                selectParentsAndWorst(steady_arr, POPULATION_SIZE, steady_ranking, STEADY_OFFSPRING_SIZE, steady_parents, steady_worst);
+                crossover(steady_arr, POPULATION_SIZE, steady_parents, steady_worst, 0, rng);
+                mutate(steady_arr, steady_worst, edge_table, rng, 32);
+                if (generation % 5 == 4){
+                    generatePopulation(steady_arr, puzzle, POPULATION_SIZE, rng); // a stagnation restart
+                }
+                assert(generation == 0 || getAllocationCount() == allocation_count);
+            }
+            freePopulation(steady_arr);
+        }
+#else
+        assert(getAllocationCount() == -1);
+#endif
+        // ---
+
+        // --- Test pushMigrant / popMigrant
+        MigrationQueue* queue = new MigrationQueue;
+        queue->head.store(0);
+        queue->tail.store(0);
+        Gene migrant[TILES_IN_PUZZLE_COUNT];
+        int migrant_fitness = -1;
+        assert(!popMigrant(*queue, migrant, migrant_fitness));
+        for (int i = 0; i < MIGRATION_QUEUE_CAPACITY; i++){
+            assert(pushMigrant(*queue, population_arr[i], i));
+        }
+        assert(!pushMigrant(*queue, population_arr[0], 0)); // full, dropped
+        for (int round = 0; round < 3; round++){
+            // wraps around the ring several times while staying in FIFO order
+            for (int i = 0; i < MIGRATION_QUEUE_CAPACITY; i++){
+                assert(popMigrant(*queue, migrant, migrant_fitness));
+                assert(migrant_fitness == i);
+                assert(memcmp(migrant, population_arr[i], TILES_IN_PUZZLE_COUNT * sizeof(Gene)) == 0);
+                assert(pushMigrant(*queue, population_arr[i], i));
+            }
+        }
+        delete queue;
+        // ---
+
+        // --- Test migrate between two islands
+        const int ISLAND_SIZE = 100;
+        IslandGroup group;
+        group.island_count = 2;
+        group.topology = RING_TOPOLOGY;
+        group.migration_interval = 1;
+        group.migrant_count = 3;
+        group.queues = new MigrationQueue[4];
+        group.island_state = nullptr;
+        for (int i = 0; i < 4; i++){
+            group.queues[i].head.store(0);
+            group.queues[i].tail.store(0);
+        }
+        Island islands[2];
+        Population island_arr[2];
+        vector<pair<int, int>> island_ranking[2];
+        for (int i = 0; i < 2; i++){
+            islands[i].group = &group;
+            islands[i].index = i;
+            island_arr[i] = allocatePopulation(ISLAND_SIZE);
+            generatePopulation(island_arr[i], puzzle, ISLAND_SIZE, rng);
+            refreshFitness(island_arr[i], ISLAND_SIZE, edge_table);
+            evaluateFitness(island_arr[i], ISLAND_SIZE, 26, island_ranking[i]);
+        }
+        int sent_best = island_ranking[0].back().second;
+        assert(migrate(island_arr[0], ISLAND_SIZE, 26, island_ranking[0], islands[0], rng) == 0);
+        assert(migrate(island_arr[1], ISLAND_SIZE, 26, island_ranking[1], islands[1], rng) == 3);
+        assert(island_ranking[1].back().second <= sent_best);
+        assert(migrate(island_arr[0], ISLAND_SIZE, 26, island_ranking[0], islands[0], rng) == 3);
+        for (int i = 0; i < 2; i++){
+            for (int j = 0; j < ISLAND_SIZE; j++){
+                assert(isPermutation(island_arr[i][j]));
+                assert(island_arr[i].fitness[j] == countEdgeMismatch(island_arr[i][j], edge_table));
+            }
+            freePopulation(island_arr[i]);
+        }
+        delete[] group.queues;
+        // ---
+
+        // --- Test evolveIslands
+        Puzzle island_best_puzzle = allocatePuzzle();
+        for (int topology = RING_TOPOLOGY; topology <= RANDOM_TOPOLOGY; topology++){
+            int island_best = evolveIslands(puzzle, 3, 300, 30, edge_table, rng, (MigrationTopology)topology, 5, 2, false, TRUNCATION_SELECTION, NO_LOCAL_SEARCH, RANDOM_INITIALIZATION, 0, island_best_puzzle);
+            assert(island_best >= 0 && island_best <= MAX_EDGE_MISMATCH_COUNT);
+            assert(isPermutation(island_best_puzzle));
+            assert(countEdgeMismatch(island_best_puzzle, edge_table) == island_best);
+        }
+        freePuzzle(island_best_puzzle);
+        // ---
+
+        // --- Test the sort-free selection operators
+        {
+            const int SELECTION_SIZE = 100000;
+            const int SELECTION_COUNT = SELECTION_SIZE / 4;
+            Population selection_arr = allocatePopulation(SELECTION_SIZE);
+            generatePopulation(selection_arr, puzzle, SELECTION_SIZE, rng);
+            refreshFitness(selection_arr, SELECTION_SIZE, edge_table);
+
+            // selectWorstUnranked finds the same worst individuals as the ranking
+            vector<pair<int, int>> selection_ranking;
+            vector<int> ranked_parents, ranked_worst, unranked_worst;
+            evaluateFitness(selection_arr, SELECTION_SIZE, SELECTION_COUNT, selection_ranking);
+            selectParentsAndWorst(selection_arr, SELECTION_SIZE, selection_ranking, SELECTION_COUNT, ranked_parents, ranked_worst);
+            int unranked_best = selectWorstUnranked(selection_arr, SELECTION_SIZE, SELECTION_COUNT, unranked_worst);
+            assert(selection_arr.fitness[unranked_best] == selection_ranking.back().second);
+            sort(ranked_worst.begin(), ranked_worst.end());
+            sort(unranked_worst.begin(), unranked_worst.end());
+            assert(ranked_worst == unranked_worst);
+
+            vector<uint8_t> excluded(SELECTION_SIZE, 0);
+            for (int i = 0; i < SELECTION_COUNT; i++){
+                excluded[unranked_worst[i]] = 1;
+            }
+            double population_mean = 0;
+            for (int i = 0; i < SELECTION_SIZE; i++){
+                population_mean += selection_arr.fitness[i];
+            }
+            population_mean /= SELECTION_SIZE;
+
+            const SelectionMethod methods[] = {TOURNAMENT_SELECTION, SUS_SELECTION, RANK_ROULETTE_SELECTION};
+            const char* method_names[] = {"tournament", "sus", "rank-roulette"};
+            vector<int> parents(SELECTION_COUNT);
+            vector<double> wheel;
+            for (int m = 0; m < 3; m++){
+                ParentSelector select_parents = getParentSelector(methods[m]);
+                select_parents(selection_arr, SELECTION_SIZE, excluded, parents, wheel, rng);
+                double parent_mean = 0;
+                for (int i = 0; i < SELECTION_COUNT; i++){
+                    assert(parents[i] >= 0 && parents[i] < SELECTION_SIZE && !excluded[parents[i]]);
+                    parent_mean += selection_arr.fitness[parents[i]];
+                }
+                // every operator favours individuals with fewer edge mismatches
+                assert(parent_mean / SELECTION_COUNT < population_mean);
+            }
+            assert(getParentSelector(TRUNCATION_SELECTION) == nullptr);
+
+            // SUS picks every individual within one of its expected number of times
+            stochasticUniversalSampling(selection_arr, SELECTION_SIZE, excluded, parents, wheel, rng);
+            vector<int> pick_count(SELECTION_SIZE, 0);
+            for (int i = 0; i < SELECTION_COUNT; i++){
+                pick_count[parents[i]]++;
+            }
+            double total_weight = 0;
+            for (int i = 0; i < SELECTION_SIZE; i++){
+                total_weight += excluded[i] ? 0 : MAX_EDGE_MISMATCH_COUNT - selection_arr.fitness[i] + 1;
+            }
+            for (int i = 0; i < SELECTION_SIZE; i++){
+                double expected = excluded[i] ? 0 : (MAX_EDGE_MISMATCH_COUNT - selection_arr.fitness[i] + 1) * SELECTION_COUNT / total_weight;
+                assert(pick_count[i] >= floor(expected) - 1e-9 && pick_count[i] <= ceil(expected) + 1e-9);
+            }
+
+            // benchmark: ranking and truncation against finding the worst and running each operator
+            const int SELECTION_REPEATS = 50;
+            start = chrono::high_resolution_clock::now();
+            for (int r = 0; r < SELECTION_REPEATS; r++){
+                evaluateFitness(selection_arr, SELECTION_SIZE, SELECTION_COUNT, selection_ranking);
+                selectParentsAndWorst(selection_arr, SELECTION_SIZE, selection_ranking, SELECTION_COUNT, ranked_parents, ranked_worst);
+            }
+            end = chrono::high_resolution_clock::now();
+            elapsed = end - start;
+            cout << "\nSelection of " << SELECTION_COUNT << " parents from " << SELECTION_SIZE << " puzzles:" << endl;
+            cout << "truncation (ranked) ---> " << elapsed.count() / SELECTION_REPEATS * 1000 << " ms" << endl;
+            for (int m = 0; m < 3; m++){
+                ParentSelector select_parents = getParentSelector(methods[m]);
+                start = chrono::high_resolution_clock::now();
+                for (int r = 0; r < SELECTION_REPEATS; r++){
+                    selectWorstUnranked(selection_arr, SELECTION_SIZE, SELECTION_COUNT, unranked_worst);
+                    select_parents(selection_arr, SELECTION_SIZE, excluded, parents, wheel, rng);
+                }
+                end = chrono::high_resolution_clock::now();
+                elapsed = end - start;
+                cout << method_names[m] << " (unranked) ---> " << elapsed.count() / SELECTION_REPEATS * 1000 << " ms" << endl;
+            }
+            freePopulation(selection_arr);
+        }
+        // ---
+
+        // --- Test FitnessBuckets track the worst and best individual
+        {
+            const int BUCKETS_SIZE = 200;
+            Population bucket_arr = allocatePopulation(BUCKETS_SIZE);
+            generatePopulation(bucket_arr, puzzle, BUCKETS_SIZE, rng);
+            refreshFitness(bucket_arr, BUCKETS_SIZE, edge_table);
+            FitnessBuckets buckets;
+            buildFitnessBuckets(bucket_arr, BUCKETS_SIZE, buckets);
+            for (int step = 0; step < 1000; step++){
+                int worst = worstInBuckets(buckets);
+                int best = bestInBuckets(buckets);
+                assert(bucket_arr.fitness[worst] == *max_element(bucket_arr.fitness, bucket_arr.fitness + BUCKETS_SIZE));
+                assert(bucket_arr.fitness[best] == *min_element(bucket_arr.fitness, bucket_arr.fitness + BUCKETS_SIZE));
+
+                // give a random individual a new fitness, sometimes the extremes
+                int individual = randomBelow(rng, BUCKETS_SIZE);
+                int fitness = step % 7 == 0 ? MAX_EDGE_MISMATCH_COUNT : step % 11 == 0 ? 0 : randomBelow(rng, MAX_EDGE_MISMATCH_COUNT + 1);
+                removeFromBuckets(buckets, individual, bucket_arr.fitness[individual]);
+                bucket_arr.fitness[individual] = fitness;
+                insertIntoBuckets(buckets, individual, fitness);
+            }
+            int bucketed_count = 0;
+            for (int fitness = 0; fitness <= MAX_EDGE_MISMATCH_COUNT; fitness++){
+                bucketed_count += buckets.bucket[fitness].size();
+            }
+            assert(bucketed_count == BUCKETS_SIZE);
+
+            // the mean tournament winner is no worse than the median individual
+            for (int i = 0; i < BUCKETS_SIZE; i++){
+                bucket_arr.fitness[i] = countEdgeMismatch(bucket_arr[i], edge_table);
+            }
+            double winner_mean = 0;
+            for (int i = 0; i < 1000; i++){
+                winner_mean += bucket_arr.fitness[tournamentSelect(bucket_arr, BUCKETS_SIZE, rng)];
+            }
+            vector<int> bucket_fitness(bucket_arr.fitness, bucket_arr.fitness + BUCKETS_SIZE);
+            nth_element(bucket_fitness.begin(), bucket_fitness.begin() + BUCKETS_SIZE / 2, bucket_fitness.end());
+            assert(winner_mean / 1000 <= bucket_fitness[BUCKETS_SIZE / 2]);
+            freePopulation(bucket_arr);
+        }
+        // ---
+
+        // --- Benchmark evolveSteadyState against evolve for the same number of children
+        {
+            const int ENGINE_POPULATION_SIZE = 1000;
+            const int ENGINE_GENERATIONS = 2000;
+            Population engine_arr = allocatePopulation(ENGINE_POPULATION_SIZE);
+            Puzzle engine_best = allocatePuzzle();
+
+            Rng engine_rng = makeRng(7, 0);
+            generatePopulation(engine_arr, puzzle, ENGINE_POPULATION_SIZE, engine_rng);
+            start = chrono::high_resolution_clock::now();
+            int steady_state_best = evolveSteadyState(engine_arr, ENGINE_GENERATIONS, ENGINE_POPULATION_SIZE, edge_table, engine_rng, false, engine_best);
+            end = chrono::high_resolution_clock::now();
+            elapsed = end - start;
+            assert(steady_state_best == countEdgeMismatch(engine_best, edge_table));
+            assert(isPermutation(engine_best));
+            for (int i = 0; i < ENGINE_POPULATION_SIZE; i++){
+                assert(isPermutation(engine_arr[i]));
+                assert(engine_arr.fitness[i] == countEdgeMismatch(engine_arr[i], edge_table));
+            }
+            cout << "\nsteady-state: lowest edge mismatch " << steady_state_best << " in " << elapsed.count() << " s" << endl;
+
+            // an island that never migrates reports its result instead of printing it
+            IslandGroup engine_group;
+            engine_group.island_count = 1;
+            engine_group.migration_interval = INT_MAX;
+            engine_group.island_state = nullptr;
+            engine_group.solved.store(false);
+            Island engine_island;
+            engine_island.group = &engine_group;
+            engine_island.index = 0;
+            engine_island.best_puzzle = engine_best;
+
+            engine_rng = makeRng(7, 0);
+            generatePopulation(engine_arr, puzzle, ENGINE_POPULATION_SIZE, engine_rng);
+            start = chrono::high_resolution_clock::now();
+            evolve(engine_arr, ENGINE_GENERATIONS, ENGINE_POPULATION_SIZE, edge_table, engine_rng, false, &engine_island);
+            end = chrono::high_resolution_clock::now();
+            elapsed = end - start;
+            cout << "generational: lowest edge mismatch " << engine_island.best_edge_mismatch << " in " << elapsed.count() << " s" << endl;
+
+            // a generation of anneal is as many moves as evolve makes children
+            engine_rng = makeRng(7, 0);
+            start = chrono::high_resolution_clock::now();
+            int annealing_best = anneal(puzzle, ENGINE_GENERATIONS, ENGINE_POPULATION_SIZE, edge_table, engine_rng, false, engine_best, makeAnnealingSettings(), RANDOM_INITIALIZATION);
+            end = chrono::high_resolution_clock::now();
+            elapsed = end - start;
+            assert(annealing_best == countEdgeMismatch(engine_best, edge_table));
+            assert(isPermutation(engine_best));
+            cout << "annealing: lowest edge mismatch " << annealing_best << " in " << elapsed.count() << " s" << endl;
+
+            freePuzzle(engine_best);
+            freePopulation(engine_arr);
+        }
+        // ---
+
+#ifndef _WIN32
+        // --- Test evolveProcesses
+        Puzzle process_best_puzzle = allocatePuzzle();
+        int process_best = evolveProcesses(puzzle, 3, 300, 30, edge_table, rng, FULLY_CONNECTED_TOPOLOGY, 5, 2, false, TRUNCATION_SELECTION, NO_LOCAL_SEARCH, RANDOM_INITIALIZATION, 0, process_best_puzzle);
+        assert(process_best >= 0 && process_best <= MAX_EDGE_MISMATCH_COUNT);
+        assert(isPermutation(process_best_puzzle));
+        assert(countEdgeMismatch(process_best_puzzle, edge_table) == process_best);
+        freePuzzle(process_best_puzzle);
+        // the launcher names its segment after its own pid and must not leave it behind
+        string segment_name = "/evol-puzzle-" + to_string(getpid());
+        assert(shm_open(segment_name.c_str(), O_RDONLY, 0) < 0 && errno == ENOENT);
+        // ---
+#endif
+
+#ifdef _OPENMP
+        // --- Benchmark generation pipeline scaling from 1 to N threads
+        const int SCALING_POPULATION_SIZE = 20000;
+        const int SCALING_OFFSPRING_SIZE = SCALING_POPULATION_SIZE / 4;
+        const int SCALING_GENERATIONS = 20;
+        Population scaling_arr = allocatePopulation(SCALING_POPULATION_SIZE);
+        vector<pair<int, int>> scaling_ranking;
+        vector<int> scaling_parents;
+        vector<int> scaling_worst;
+        double single_thread_rate = 0;
+
+        cout << "\nGeneration pipeline scaling (" << SCALING_POPULATION_SIZE << " puzzles):" << endl;
+        for (int thread_count = 1; thread_count <= omp_get_num_procs(); thread_count++){
+            omp_set_num_threads(thread_count);
+            Rng scaling_rng = makeRng(1, 0);
+            generatePopulation(scaling_arr, puzzle, SCALING_POPULATION_SIZE, scaling_rng);
+
+            start = chrono::high_resolution_clock::now();
+            for (int generation = 0; generation < SCALING_GENERATIONS; generation++){
+                refreshFitness(scaling_arr, SCALING_POPULATION_SIZE, edge_table);
+                evaluateFitness(scaling_arr, SCALING_POPULATION_SIZE, SCALING_OFFSPRING_SIZE, scaling_ranking);
+                selectParentsAndWorst(scaling_arr, SCALING_POPULATION_SIZE, scaling_ranking, SCALING_OFFSPRING_SIZE, scaling_parents, scaling_worst);
+                // always recombine, the most expensive path
+                crossover(scaling_arr, SCALING_POPULATION_SIZE, scaling_parents, scaling_worst, 0, scaling_rng);
+                mutate(scaling_arr, scaling_worst, edge_table, scaling_rng, 32);
+            }
+            end = chrono::high_resolution_clock::now();
+            elapsed = end - start;
+
+            double rate = SCALING_GENERATIONS / elapsed.count();
+            if (thread_count == 1){
+                single_thread_rate = rate;
+            }
+            cout << "threads: " << thread_count << " ---> " << rate << " generations/s (" << rate / single_thread_rate << "x)" << endl;
+        }
+
+        refreshFitness(scaling_arr, SCALING_POPULATION_SIZE, edge_table);
+        for (int i = 0; i < SCALING_POPULATION_SIZE; i++){
+            assert(isPermutation(scaling_arr[i]));
+            assert(scaling_arr.fitness[i] == countEdgeMismatch(scaling_arr[i], edge_table));
+        }
+        freePopulation(scaling_arr);
+        // ---
+#endif
+
+        freePopulation(population_arr);
+        freePuzzle(puzzle);
+    }
+};
+
+/**
+ * @brief Writes a solvable WIDTH x HEIGHT puzzle whose edges use motifs 0 to motif_count - 1.
+ *
+ * The tiles are written solved, in input order, so the input arrangement has no mismatch.
+ *
+ * @param filename The file to write.
+ * @param width The number of tiles on each line.
+ * @param height The number of lines.
+ * @param motif_count The number of motifs, every one of which is used.
+ */
+void writeSolvedPuzzle(const string &filename, int width, int height, int motif_count){
+    Rng rng = makeRng(7, width * 100 + height);
+    // horizontal[r][c] is the motif between rows r - 1 and r, vertical[r][c] between columns c - 1 and c
+    vector<vector<int>> horizontal(height + 1, vector<int>(width));
+    vector<vector<int>> vertical(height, vector<int>(width + 1));
+    int next_motif = 0;
+    for (vector<int> &row : horizontal){
+        for (int &motif : row){
+            motif = next_motif < motif_count ? next_motif++ : randomBelow(rng, motif_count);
         }
     }
-    pair<int, int> crossoverPoints = twoPointCrossover(parent3, parent4);
-    int point1 = crossoverPoints.first;
-    int point2 = crossoverPoints.second;
-
-    // Verify the crossover operation
-    for (int i = 0; i < point1; i++) {
-        assert(assertArrayEqual(parent3[i], initialParent3[i]));
-        assert(assertArrayEqual(parent4[i], initialParent4[i]));
+    for (vector<int> &row : vertical){
+        for (int &motif : row){
+            motif = randomBelow(rng, motif_count);
+        }
     }
 
-    for (int i = point1; i <= point2; i++) {
-        assert(assertArrayEqual(parent3[i], initialParent4[i]));
-        assert(assertArrayEqual(parent4[i], initialParent3[i]));
+    ofstream file(filename);
+    for (int r = 0; r < height; r++){
+        for (int c = 0; c < width; c++){
+            file << motifToChar(horizontal[r][c]) << motifToChar(vertical[r][c + 1])
+                 << motifToChar(horizontal[r + 1][c]) << motifToChar(vertical[r][c]) << " ";
+        }
+        file << "\n";
     }
+}
 
-    for (int i = point2 + 1; i < TILES_IN_PUZZLE_COUNT; i++) {
-        assert(assertArrayEqual(parent3[i], initialParent3[i]));
-        assert(assertArrayEqual(parent4[i], initialParent4[i]));
+/**
+ * @brief Solves a puzzle file with the instantiation dispatchGeometry picked for it.
+ *
+ * @return MOTIFS, so the caller can check which motif capacity was picked.
+ */
+template<int WIDTH, int HEIGHT, int MOTIFS>
+struct DispatchTest {
+    typedef EvolPuzzle<WIDTH, HEIGHT, MOTIFS> P;
+
+    static int run(const string &filename){
+        typename P::Tile input_tiles[P::TILES_IN_PUZZLE_COUNT];
+        P::readInput(filename, input_tiles);
+        typename P::EdgeTable edge_table = P::buildEdgeTable(input_tiles);
+
+        typename P::Puzzle puzzle = P::allocatePuzzle();
+        P::writeInputOrder(puzzle);
+        assert(P::countEdgeMismatch(puzzle, edge_table) == 0);
+        assert(P::countEdgeMismatch(puzzle, edge_table) == P::countEdgeMismatchScalar(puzzle, edge_table));
+
+        long long node_count;
+        typename P::Puzzle solution = P::allocatePuzzle();
+        assert(P::solveExact(solution, edge_table, EXACT_NODE_LIMIT, node_count));
+        assert(P::countEdgeMismatch(solution, edge_table) == 0);
+
+        P::freePuzzle(solution);
+        P::freePuzzle(puzzle);
+        return MOTIFS;
     }
+};
 
-    // ---
+int main(){
+    PuzzleTest::run();
+
+    // --- Test readInputShape and dispatchGeometry on other geometries
+    int width, height, motif_count;
+    readInputShape("Ass1Input.txt", width, height, motif_count);
+    assert(width == 8 && height == 8 && motif_count == 7);
 
-    // --- Test evaluateFitness
-    vector<pair<int, int>> fitness_results = evaluateFitness(population_arr, POPULATION_SIZE);
+    string filename = "dispatch-test.txt";
+    writeSolvedPuzzle(filename, 4, 4, SMALL_MOTIF_COUNT);
+    readInputShape(filename, width, height, motif_count);
+    assert(width == 4 && height == 4 && motif_count == SMALL_MOTIF_COUNT);
+    assert(dispatchGeometry<DispatchTest>(width, height, motif_count, filename) == SMALL_MOTIF_COUNT);
 
-    // checking if sorted properly
-    for (int i = 1; i < fitness_results.size(); i++) {
-        assert(fitness_results[i-1].second >= fitness_results[i].second);
+    writeSolvedPuzzle(filename, 5, 5, 20);
+    readInputShape(filename, width, height, motif_count);
+    assert(width == 5 && height == 5 && motif_count == 20);
+    assert(dispatchGeometry<DispatchTest>(width, height, motif_count, filename) == MAX_MOTIF_COUNT);
+
+    writeSolvedPuzzle(filename, 3, 3, 4);
+    readInputShape(filename, width, height, motif_count);
+    bool unsupported = false;
+    try {
+        dispatchGeometry<DispatchTest>(width, height, motif_count, filename);
+    } catch (const runtime_error &error) {
+        unsupported = string(error.what()).find("no solver for 3x3 puzzles") != string::npos;
     }
+    assert(unsupported);
+    remove(filename.c_str());
+    // ---
+
+    // --- Test parseRunOptions: every flag reaches its field
+    const char* arguments[] = {"main", "-v", "--seed", "12345", "--islands", "3", "--processes", "2",
+        "--topology", "full", "--migration-interval", "7", "--migrants", "4", "--selection", "sus",
+        "--local-search", "best", "--init", "greedy", "--steady-state", "--anneal", "--cooling", "linear",
+        "--temperatures", "3", "0.5", "--reheat-interval", "9", "--replicas", "5", "--exact",
+        "--exact-nodes", "1000", "--completion-nodes", "200"};
+    RunOptions options;
+    parseRunOptions(sizeof(arguments) / sizeof(arguments[0]), const_cast<char**>(arguments), options);
+    assert(options.print_flag && options.seed == 12345);
+    assert(options.island_count == 3 && options.process_count == 2);
+    assert(options.topology == FULLY_CONNECTED_TOPOLOGY);
+    assert(options.migration_interval == 7 && options.migrant_count == 4);
+    assert(options.selection_method == SUS_SELECTION);
+    assert(options.local_search_method == BEST_IMPROVEMENT_LOCAL_SEARCH);
+    assert(options.initialization_method == GREEDY_INITIALIZATION);
+    assert(options.steady_state_flag && options.anneal_flag && options.exact_flag);
+    assert(options.annealing_settings.schedule == LINEAR_COOLING);
+    assert(options.annealing_settings.initial_temperature == 3 && options.annealing_settings.final_temperature == 0.5);
+    assert(options.annealing_settings.reheat_interval == 9 && options.annealing_settings.replica_count == 5);
+    assert(options.exact_node_limit == 1000 && options.completion_node_limit == 200);
+
+    const char* random_topology[] = {"main", "--topology", "random", "--seed", "0"};
+    RunOptions random_options;
+    parseRunOptions(5, const_cast<char**>(random_topology), random_options);
+    assert(random_options.topology == RANDOM_TOPOLOGY && random_options.seed == 0);
+    // ---
 
     cout << "\n\n" << "All tests passed!" << "\n\n";
 
     return 0;
-}
\ No newline at end of file
+}